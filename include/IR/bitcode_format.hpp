@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scbe::IR::Bitcode {
+
+// Layout of a version 3 file, all integers are little endian:
+//   header:    u32 magic, u32 version, string unit name
+//   types:     varint count, entries, then the element lists of every struct (so recursive structs work)
+//   constants: varint count, u32 offset per entry (relative to the first entry) plus the end offset, entries
+//   globals:   varint count, entries (name, type, linkage, flags, initializer)
+//   functions: varint count, entries, each pointing (u64 offset, u64 size) to its body
+//   bodies
+// Strings are a varint length followed by the bytes, signed values are zigzag encoded varints.
+// A type reference is its index + 1, 0 means no type.
+
+static constexpr uint32_t s_magic = 0x52494353; // SCIR
+static constexpr uint32_t s_version = 3;
+
+enum class OperandTag : uint8_t {
+    Argument,
+    Instruction,
+    Block,
+    Constant,
+};
+
+inline void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if(value) byte |= 0x80;
+        out.push_back(byte);
+    } while(value);
+}
+
+inline void writeSigned(std::vector<uint8_t>& out, int64_t value) {
+    writeVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+inline void writeFixed(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for(size_t i = 0; i < bytes; i++)
+        out.push_back((value >> (i * 8)) & 0xFF);
+}
+
+inline void writeString(std::vector<uint8_t>& out, std::string_view value) {
+    writeVarint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+class Cursor {
+public:
+    Cursor(const uint8_t* begin, const uint8_t* end) : m_current(begin), m_end(end) {}
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for(uint32_t shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = readByte();
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if(!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Malformed bitcode: varint too long");
+    }
+
+    int64_t readSigned() {
+        uint64_t value = readVarint();
+        return (int64_t)((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    uint64_t readFixed(size_t bytes) {
+        check(bytes);
+        uint64_t value = 0;
+        for(size_t i = 0; i < bytes; i++)
+            value |= (uint64_t)m_current[i] << (i * 8);
+        m_current += bytes;
+        return value;
+    }
+
+    std::string readString() {
+        uint64_t size = readVarint();
+        check(size);
+        std::string value((const char*)m_current, size);
+        m_current += size;
+        return value;
+    }
+
+    std::vector<uint8_t> readBytes() {
+        uint64_t size = readVarint();
+        check(size);
+        std::vector<uint8_t> value(m_current, m_current + size);
+        m_current += size;
+        return value;
+    }
+
+    // a count of entries that take at least minimumSize bytes each, checked so a corrupt count can't allocate more than the data holds
+    uint64_t readCount(uint64_t minimumSize = 1) {
+        uint64_t count = readVarint();
+        if(count > (uint64_t)(m_end - m_current) / minimumSize) throw std::runtime_error("Malformed bitcode: count out of bounds");
+        return count;
+    }
+    template<typename T>
+    T readEnum(uint64_t count, const char* what) {
+        uint64_t value = readVarint();
+        if(value >= count) throw std::runtime_error(std::string("Malformed bitcode: unknown ") + what);
+        return (T)value;
+    }
+
+    uint8_t readByte() {
+        check(1);
+        return *m_current++;
+    }
+
+    const uint8_t* getCurrent() const { return m_current; }
+
+private:
+    void check(uint64_t bytes) const {
+        if(bytes > (uint64_t)(m_end - m_current)) throw std::runtime_error("Malformed bitcode: unexpected end of data");
+    }
+
+private:
+    const uint8_t* m_current = nullptr;
+    const uint8_t* m_end = nullptr;
+};
+
+}
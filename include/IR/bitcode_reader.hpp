@@ -0,0 +1,81 @@
+#pragma once
+
+#include "type_alias.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace scbe {
+class Unit;
+class Type;
+}
+
+namespace scbe::IR {
+
+class Constant;
+class Function;
+class GlobalVariable;
+
+// Reads a unit written by BitcodeWriter.
+// The file is memory mapped, types, globals and function declarations are created by readInto,
+// function bodies only when materialize is called for them. The reader has to outlive any pending materialization.
+class BitcodeReader {
+public:
+    BitcodeReader(const std::string& path);
+    BitcodeReader(std::vector<uint8_t> buffer);
+    ~BitcodeReader();
+
+    BitcodeReader(const BitcodeReader&) = delete;
+    BitcodeReader& operator=(const BitcodeReader&) = delete;
+
+    const std::string& getUnitName() const { return m_unitName; }
+
+    void readInto(Unit& unit);
+
+    bool isMaterializable(Function* function) const;
+    void materialize(Function* function);
+    void materializeAll();
+
+private:
+    void readHeader();
+    Type* getType(uint64_t reference);
+    Constant* getConstant(uint64_t index);
+    GlobalVariable* getGlobal(uint64_t index);
+
+private:
+    struct GlobalRecord {
+        std::string m_name;
+        uint64_t m_type;
+        uint64_t m_linkage;
+        uint64_t m_flags;
+        uint64_t m_value;
+    };
+
+    struct BodyRecord {
+        uint64_t m_offset = 0;
+        uint64_t m_size = 0;
+        bool m_materialized = false;
+    };
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    std::vector<uint8_t> m_buffer;
+    void* m_mapping = nullptr;
+
+    std::string m_unitName;
+    const uint8_t* m_sections = nullptr;
+
+    Unit* m_unit = nullptr;
+    std::vector<Type*> m_types;
+    std::vector<const uint8_t*> m_constantEntries;
+    std::vector<Constant*> m_constants;
+    USet<uint64_t> m_constantsInProgress;
+    std::vector<GlobalRecord> m_globalRecords;
+    std::vector<GlobalVariable*> m_globals;
+    USet<uint64_t> m_globalsInProgress;
+    std::vector<Function*> m_functions;
+    UMap<Function*, BodyRecord> m_bodies;
+};
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "type_alias.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace scbe {
+class Unit;
+class Type;
+class StructType;
+}
+
+namespace scbe::IR {
+
+class Constant;
+class Function;
+class GlobalVariable;
+class Value;
+
+// Serializes a unit to the binary format described in bitcode_format.hpp, read back with BitcodeReader.
+class BitcodeWriter {
+public:
+    BitcodeWriter(std::ostream& output) : m_output(output) {}
+
+    void write(Unit& unit);
+
+private:
+    uint64_t getTypeIndex(Type* type);
+    uint64_t getConstantIndex(Constant* constant);
+
+    void writeFunctionBody(std::vector<uint8_t>& out, Function* function);
+    void writeOperand(std::vector<uint8_t>& out, Value* value, const UMap<Value*, uint64_t>& locals, const UMap<Value*, uint64_t>& blocks);
+
+private:
+    std::ostream& m_output;
+
+    std::vector<uint8_t> m_types;
+    uint64_t m_typeCount = 0;
+    UMap<Type*, uint64_t> m_typeIndices;
+    std::vector<StructType*> m_structs;
+
+    std::vector<std::vector<uint8_t>> m_constants;
+    UMap<Constant*, uint64_t> m_constantIndices;
+
+    UMap<GlobalVariable*, uint64_t> m_globalIndices;
+    UMap<Function*, uint64_t> m_functionIndices;
+};
+
+}
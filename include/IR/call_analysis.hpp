@@ -8,6 +8,7 @@ class Block;
 
 class CallAnalysis : public FunctionPass {
 public:
+    const char* getName() const override { return "call-analysis"; }
     bool run(Function* function) override;
 };
 
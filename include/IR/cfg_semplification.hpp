@@ -6,6 +6,7 @@ namespace scbe::IR {
 
 class CFGSemplification : public FunctionPass {
 public:
+    const char* getName() const override { return "cfg-simplification"; }
     bool run(IR::Function* function) override;
 
     bool mergeBlocks(IR::Function* function);
@@ -13,6 +13,7 @@ class ConstantFolder : public InstructionPass {
 public:
     ConstantFolder(Ref<Context> context) : InstructionPass(), m_folder(context), m_context(context) {}
 
+    const char* getName() const override { return "constant-folder"; }
     bool run(IR::Instruction* instruction) override;
 
 private:
@@ -6,6 +6,7 @@ namespace scbe::IR {
 
 class DeadCodeElimination : public FunctionPass {
 public:
+    const char* getName() const override { return "dce"; }
     bool run(IR::Function* function) override;
 
 private:
@@ -6,6 +6,7 @@ namespace scbe::IR {
 
 class FixPhis : public InstructionPass {
 public:
+    const char* getName() const override { return "fix-phis"; }
     bool run(Instruction* instruction) override;
 };
 
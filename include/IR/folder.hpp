@@ -11,12 +11,15 @@ public:
 
     Value* foldBinOp(Instruction::Opcode opcode, Value* lhs, Value* rhs);
     Value* foldCast(Instruction::Opcode opcode, Value* value, Type* type);
+    // loads of scalars out of read only globals, through constant indices
+    Value* foldLoad(Value* ptr);
 
 private:
     template<typename T, typename F>
     Value* foldBinOpInternal(Instruction::Opcode opcode, T* lhs, T* rhs, std::function<T*(F)> constructor);
     
     Value* foldBinOpInternalInt(Instruction::Opcode opcode, ConstantInt* lhs, ConstantInt* rhs);
+    Constant* getElement(Constant* aggregate, int64_t index);
 
     template<typename T>
     Value* foldCastInternal(Instruction::Opcode opcode, T* value, Type* type);
@@ -35,6 +35,8 @@ public:
     bool isDominatorTreeDirty() const { return m_dominatorTreeDirty; }
     bool hasBody() const { return !m_blocks.empty(); }
     bool isRecursive() const { return m_isRecursive; }
+    // Precompiled functions already have machine code (e.g. from a compilation cache) and are skipped by the pass manager
+    bool isPrecompiled() const { return m_isPrecompiled; }
 
     void replace(Value* replace, Value* with);
 
@@ -46,6 +48,7 @@ public:
     void removeBlock(Block* block);
     void setCFGDirty() { m_dominatorTreeDirty = true; m_heuristicsDirty = true; }
     void setCallingConvention(CallingConvention cc) { m_callConv = cc; }
+    void setPrecompiled(bool precompiled) { m_isPrecompiled = precompiled; }
 
     Block* insertBlock(const std::string name = "");
     Block* insertBlockAfter(Block* after, const std::string name = "");
@@ -83,6 +86,7 @@ protected:
     bool m_dominatorTreeDirty = true;
     bool m_heuristicsDirty = true;
     bool m_isRecursive = false;
+    bool m_isPrecompiled = false;
 
     Heuristics m_heuristics;
     
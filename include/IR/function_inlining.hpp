@@ -7,6 +7,7 @@ class FunctionInlining : public FunctionPass {
 public:
     void init(Unit& unit) override { m_totalInstructionsAdded = 0; }
 
+    const char* getName() const override { return "inline"; }
     bool run(Function* function) override;
 
 private:
@@ -36,11 +36,16 @@ class GlobalVariable : public GlobalValue {
 public:
     Constant* getValue() const { return m_value; }
 
+    // read only globals are placed in read only sections, the program must never store to them
+    bool isReadOnly() const { return m_readOnly; }
+    void setReadOnly(bool readOnly) { m_readOnly = readOnly; }
+
 protected:
     GlobalVariable(Type* type, Constant* value, Linkage linkage, const std::string& name) : GlobalValue(type, linkage, ValueKind::GlobalVariable, name), m_value(value) {}
 
 protected:
     Constant* m_value = nullptr;
+    bool m_readOnly = false;
 
 friend class scbe::Unit;
 };
@@ -153,7 +153,7 @@ class StoreInstruction : public Instruction {
 public:
     StoreInstruction(Value* ptr, Value* value, std::string name = "") : Instruction(Opcode::Store, ptr->getType(), name) {
         assert(ptr->getType()->getKind() == Type::TypeKind::Pointer && "Expected pointer type");
-        assert(!value->isConstantArray() && !value->isConstantStruct() && "Cannot store complex values. Use a memcpy or manual copy");
+        assert(!value->isConstantArray() && !value->isConstantStruct() && !value->isConstantDataArray() && !value->isConstantAggregateZero() && "Cannot store complex values. Use a memcpy or manual copy");
         addOperand(ptr); addOperand(value);
     }
     CLONE(StoreInstruction)
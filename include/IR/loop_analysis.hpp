@@ -9,6 +9,7 @@ class LoopInfo;
 
 class LoopAnalysis : public FunctionPass {
 public:
+    const char* getName() const override { return "loop-analysis"; }
     bool run(IR::Function* function) override;
     void propagateDepth(LoopInfo* loop, uint32_t depth);
 };
@@ -11,6 +11,7 @@ class Mem2Reg : public FunctionPass {
 public:
     Mem2Reg(Ref<Context> context) : m_context(context) {}
 
+    const char* getName() const override { return "mem2reg"; }
     bool run(IR::Function* function) override;
 
     void rename(IR::DominatorTree* tree, IR::Block* current, UMap<IR::Value*, std::vector<IR::Value*>>& stack, const std::vector<IR::AllocateInstruction*>& promoted);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "IR/instruction.hpp"
+#include "type_alias.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scbe {
+class Unit;
+class Context;
+}
+
+namespace scbe::IR {
+
+class Constant;
+class GlobalVariable;
+
+// Parses the textual form emitted by HumanPrinter back into a unit.
+// Errors are reported as std::runtime_error with a "file:line:column" prefix.
+class Parser {
+public:
+    Parser(std::string source, Ref<Context> context, std::string fileName = "<input>");
+
+    std::unique_ptr<Unit> parse();
+
+private:
+    struct Token {
+        enum class Kind {
+            Identifier,
+            Local,
+            Global,
+            Number,
+            String,
+            Punctuation,
+            End,
+        };
+
+        Kind m_kind;
+        std::string m_text;
+        uint32_t m_line;
+        uint32_t m_column;
+    };
+
+    // An instruction operand, locals and blocks are resolved once the whole body is known
+    struct Operand {
+        enum class Kind {
+            Value,
+            Local,
+            Block,
+        };
+
+        Kind m_kind;
+        Value* m_value = nullptr;
+        Type* m_type = nullptr;
+        std::string m_name;
+        size_t m_token = 0;
+    };
+
+    struct InstructionRecord {
+        Instruction::Opcode m_opcode;
+        std::string m_name;
+        Type* m_type = nullptr;
+        std::vector<Operand> m_operands;
+        size_t m_block = 0;
+        size_t m_token = 0;
+    };
+
+    void tokenize();
+
+    const Token& peek(size_t offset = 0) const;
+    const Token& next();
+    bool check(const std::string& punctuation, size_t offset = 0) const;
+    bool accept(const std::string& punctuation);
+    void expect(const std::string& punctuation);
+    std::string expectIdentifier();
+    [[noreturn]] void error(const std::string& message, size_t token) const;
+
+    void parseStructDefinition();
+    void parseFunctionHeader();
+    void skipGlobal();
+    void skipConstant();
+    GlobalVariable* getGlobal(size_t declaration);
+    void parseFunctionBody(Function* function);
+    InstructionRecord parseInstruction();
+
+    Type* parseType();
+    Constant* parseConstant();
+    Constant* parseConstant(Type* type, size_t token);
+    Operand parseOperand();
+    Operand parseBlockOperand();
+    std::vector<Operand> parseOperandList();
+
+    std::unique_ptr<Instruction> createInstruction(const InstructionRecord& record, const std::vector<Value*>& operands);
+
+private:
+    std::string m_source;
+    std::string m_fileName;
+    Ref<Context> m_context;
+    std::unique_ptr<Unit> m_unit;
+
+    std::vector<Token> m_tokens;
+    size_t m_current = 0;
+
+    UMap<std::string, StructType*> m_structs;
+    UMap<std::string, Function*> m_functions;
+    // globals are created on first use so initializers can refer to later declarations
+    std::vector<size_t> m_globalDeclarations;
+    UMap<std::string, size_t> m_globalNames;
+    UMap<size_t, GlobalVariable*> m_globals;
+    USet<size_t> m_globalsInProgress;
+    std::vector<std::pair<Function*, size_t>> m_bodies;
+    UMap<std::string, Value*> m_arguments;
+    Function* m_function = nullptr;
+};
+
+}
@@ -8,6 +8,7 @@ class SplitCriticalEdge : public FunctionPass {
 public:
     SplitCriticalEdge(Ref<Context> ctx) : m_ctx(ctx) {}
 
+    const char* getName() const override { return "split-critical-edge"; }
     bool run(Function* function) override;
 
 private:
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "type_alias.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+namespace scbe {
+class Type;
+}
+
+namespace scbe::IR {
+
+class Function;
+class Value;
+class Constant;
+
+// Computes a hash of a function that only depends on its structure, never on pointers or local value/block names,
+// so it stays the same across runs and can be used as a content address.
+// When callee bodies are included, every function that could be inlined contributes to the hash as well.
+class StructuralHash {
+public:
+    StructuralHash(bool includeCalleeBodies) : m_includeCalleeBodies(includeCalleeBodies) {}
+
+    uint64_t hash(Function* function);
+
+private:
+    struct State {
+        uint64_t m_hash = 0xcbf29ce484222325ULL;
+        Function* m_function = nullptr;
+        UMap<Value*, size_t> m_numbering;
+    };
+
+    void add(State& state, uint64_t value);
+    void add(State& state, std::string_view value);
+    void addType(State& state, Type* type);
+    void addValue(State& state, Value* value);
+    void addConstant(State& state, Constant* constant);
+
+private:
+    bool m_includeCalleeBodies = false;
+    bool m_cycle = false;
+    UMap<Function*, uint64_t> m_cache;
+    USet<Function*> m_inProgress;
+    USet<Type*> m_typeStack;
+    USet<Value*> m_globalStack;
+};
+
+}
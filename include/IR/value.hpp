@@ -21,6 +21,8 @@ public:
         ConstantFloat,
         ConstantStruct,
         ConstantArray,
+        ConstantDataArray,
+        ConstantAggregateZero,
         Block,
         Function,
         GlobalVariable,
@@ -59,6 +61,8 @@ public:
     bool isConstantFloat() const { return m_kind == ValueKind::ConstantFloat; }
     bool isConstantStruct() const { return m_kind == ValueKind::ConstantStruct; }
     bool isConstantArray() const { return m_kind == ValueKind::ConstantArray; }
+    bool isConstantDataArray() const { return m_kind == ValueKind::ConstantDataArray; }
+    bool isConstantAggregateZero() const { return m_kind == ValueKind::ConstantAggregateZero; }
     bool isBlock() const { return m_kind == ValueKind::Block; }
     bool isFunction() const { return m_kind == ValueKind::Function; }
     bool isRegister() const { return m_kind == ValueKind::Register; }
@@ -68,7 +72,7 @@ public:
     bool isNullValue() const { return m_kind == ValueKind::NullValue; }
     bool isConstantGEP() const { return m_kind == ValueKind::ConstantGEP; }
 
-    bool isConstant() const { return m_kind >= ValueKind::ConstantInt && m_kind <= ValueKind::ConstantArray; }
+    bool isConstant() const { return m_kind >= ValueKind::ConstantInt && m_kind <= ValueKind::ConstantAggregateZero; }
 
 protected:
     Value(std::string name, Type* type, ValueKind kind) : m_name(std::move(name)), m_type(type), m_kind(kind) {}
@@ -150,7 +154,6 @@ friend class scbe::Context;
 class ConstantArray : public ConstantMultiple {
 public:
     static ConstantArray* get(ArrayType* type, const std::vector<Constant*>& values, Ref<Context> context);
-    static ConstantArray* fromString(const std::string& str, Ref<Context> context);
 
 protected:
     ConstantArray(ArrayType* type, const std::vector<Constant*>& values) : ConstantMultiple(ValueKind::ConstantArray, type, values) {}
@@ -158,6 +161,49 @@ protected:
 friend class scbe::Context;
 };
 
+// An array of integers or floats stored as packed little endian bytes instead of one constant per element
+class ConstantDataArray : public Constant {
+public:
+    static ConstantDataArray* get(ArrayType* type, std::vector<uint8_t> data, Ref<Context> context);
+    // packs ConstantInt or ConstantFloat elements
+    static ConstantDataArray* get(ArrayType* type, const std::vector<Constant*>& values, Ref<Context> context);
+    static ConstantDataArray* fromString(const std::string& str, Ref<Context> context);
+
+    const std::vector<uint8_t>& getData() const { return m_data; }
+    Type* getElementType() const { return static_cast<ArrayType*>(m_type)->getElement(); }
+    size_t getNumElements() const { return static_cast<ArrayType*>(m_type)->getScale(); }
+    size_t getElementSize() const;
+
+    int64_t getElementAsInt(size_t index) const;
+    double getElementAsFloat(size_t index) const;
+    Constant* getElementAsConstant(size_t index, Ref<Context> context) const;
+
+    // an i8 array ending with its only null
+    bool isString() const;
+    std::string getAsString() const;
+
+protected:
+    ConstantDataArray(ArrayType* type, std::vector<uint8_t> data) : Constant(type, ValueKind::ConstantDataArray), m_data(std::move(data)) {}
+
+private:
+    std::vector<uint8_t> m_data;
+
+friend class scbe::Context;
+};
+
+// All zero struct or array
+class ConstantAggregateZero : public Constant {
+public:
+    static ConstantAggregateZero* get(Type* type, Ref<Context> context);
+
+    Constant* getElement(size_t index, DataLayout* layout, Ref<Context> context) const;
+
+protected:
+    ConstantAggregateZero(Type* type) : Constant(type, ValueKind::ConstantAggregateZero) {}
+
+friend class scbe::Context;
+};
+
 class FunctionArgument : public Value {
 public:
     FunctionArgument(const std::string& name, Type* type, uint32_t slot) : Value(name, type, ValueKind::FunctionArgument), m_slot(slot) {}
@@ -7,16 +7,21 @@
 namespace scbe::IR {
 
 class Block;
+class Constant;
+class GlobalVariable;
 
 class Verifier : public FunctionPass {
 public:
     Verifier(DiagnosticEmitter* emitter, DataLayout* layout) : m_diagnosticEmitter(emitter), m_layout(layout) {}
 
+    const char* getName() const override { return "verifier"; }
     bool run(Function* functon);
+    void init(Unit& unit) override;
 
 private:
     void verify(Block* block);
     void verify(Instruction* instruction);
+    void verify(Constant* constant, GlobalVariable* global);
 
 private:
     DiagnosticEmitter* m_diagnosticEmitter = nullptr;
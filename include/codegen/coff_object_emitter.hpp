@@ -6,7 +6,7 @@ namespace scbe::Codegen {
 
 class COFFObjectEmitter : public ObjectEmitter {
 public:
-    COFFObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info) : ObjectEmitter(output, encoder, info) {}
+    COFFObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info, Ref<CompilationCache> cache = nullptr) : ObjectEmitter(output, encoder, info, cache) {}
 
     void emitObjectFile(Unit& unit) override;
 };
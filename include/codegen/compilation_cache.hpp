@@ -0,0 +1,89 @@
+#pragma once
+
+#include "codegen/fixup.hpp"
+#include "IR/structural_hash.hpp"
+#include "opt_level.hpp"
+#include "pass.hpp"
+#include "target/target_specification.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace scbe::Codegen {
+
+struct CachedData {
+    std::vector<uint8_t> m_bytes;
+    std::vector<Fixup> m_fixups;
+    bool m_readOnly = false;
+};
+
+// Relocatable machine code of a single function.
+// Text fixups are relative to the start of the code, data fixups to the start of their data entry.
+// Branches between blocks of the function are already resolved, data that was generated while compiling it
+// (constant pools, jump tables) is stored alongside and referenced through getPrivateDataName.
+struct CachedFunction {
+    std::vector<uint8_t> m_code;
+    std::vector<Fixup> m_fixups;
+    std::vector<CachedData> m_data;
+};
+
+class CompilationCache {
+public:
+    // Entries always live in memory, when a directory is given they are also persisted there.
+    CompilationCache(const std::string& directory = "") : m_directory(directory) {}
+
+    // Looks the key up in memory and then on disk, counting a hit or a miss
+    const CachedFunction* find(uint64_t key);
+    const CachedFunction* get(uint64_t key) const { return m_entries.contains(key) ? &m_entries.at(key) : nullptr; }
+    void insert(uint64_t key, CachedFunction entry);
+
+    std::optional<uint64_t> getKey(IR::Function* function) const;
+    bool isSourceGlobal(const std::string& name) const { return m_sourceGlobals.contains(name); }
+
+    size_t getHits() const { return m_hits; }
+    size_t getMisses() const { return m_misses; }
+    size_t getSize() const { return m_entries.size(); }
+    void resetStatistics() { m_hits = 0; m_misses = 0; }
+
+    static std::string getPrivateDataName(const std::string& function, size_t index);
+
+private:
+    std::optional<CachedFunction> load(uint64_t key) const;
+    void save(uint64_t key, const CachedFunction& entry) const;
+    std::string getPath(uint64_t key) const;
+
+private:
+    std::string m_directory;
+    UMap<uint64_t, CachedFunction> m_entries;
+
+    UMap<IR::Function*, uint64_t> m_keys;
+    USet<std::string> m_sourceGlobals;
+
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+
+friend class CompilationCacheLookup;
+};
+
+// Has to run before anything touches the IR.
+// Computes the key of every function and marks hits as precompiled, so the rest of the pipeline skips them
+// and the object emitter splices the cached code in.
+class CompilationCacheLookup : public FunctionPass {
+public:
+    CompilationCacheLookup(Ref<CompilationCache> cache, Target::TargetSpecification spec, OptimizationLevel level)
+        : FunctionPass(), m_cache(cache), m_spec(spec), m_level(level), m_hasher(level >= OptimizationLevel::O1) {}
+
+    void init(Unit& unit) override;
+    const char* getName() const override { return "compilation-cache-lookup"; }
+    bool run(IR::Function* function) override;
+
+private:
+    Ref<CompilationCache> m_cache;
+    Target::TargetSpecification m_spec;
+    OptimizationLevel m_level;
+    IR::StructuralHash m_hasher;
+};
+
+}
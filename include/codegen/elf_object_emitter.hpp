@@ -6,7 +6,7 @@ namespace scbe::Codegen {
 
 class ELFObjectEmitter : public ObjectEmitter {
 public:
-    ELFObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info) : ObjectEmitter(output, encoder, info) {}
+    ELFObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info, Ref<CompilationCache> cache = nullptr, ObjectFileOptions options = {}) : ObjectEmitter(output, encoder, info, cache, options) {}
 
     void emitObjectFile(Unit& unit) override;
 };
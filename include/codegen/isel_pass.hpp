@@ -5,6 +5,8 @@
 #include "opt_level.hpp"
 #include "pass.hpp"
 
+#include <map>
+
 namespace scbe {
 class DataLayout;
 }
@@ -46,6 +48,7 @@ public:
     ISelPass(Target::InstructionInfo* instrInfo, Target::RegisterInfo* registerInfo, DataLayout* dataLayout, Ref<Context> context, OptimizationLevel level)
         : FunctionPass(), m_instructionInfo(instrInfo), m_registerInfo(registerInfo), m_dataLayout(dataLayout), m_context(context), m_optLevel(level) {}
 
+    const char* getName() const override { return "isel"; }
     bool run(IR::Function* function) override;
     void init(Unit& unit) override;
     void selectPattern(ISel::Node* node);
@@ -79,9 +82,10 @@ private:
     UMap<ISel::Node*, MatchResult> m_bestMatch;
 
     UMap<IR::Value*, ISel::Register*> m_registers;
-    UMap<size_t, ISel::ConstantInt*> m_constantInts;
-    UMap<size_t, ISel::ConstantFloat*> m_constantFloats;
-    UMap<size_t, ISel::FrameIndex*> m_frameIndices;
+    // keyed by the values themselves, a hash alone can collide and hand back the wrong node
+    std::map<std::pair<int64_t, Type*>, ISel::ConstantInt*> m_constantInts;
+    std::map<std::pair<uint64_t, Type*>, ISel::ConstantFloat*> m_constantFloats;
+    std::map<std::pair<uint32_t, Type*>, ISel::FrameIndex*> m_frameIndices;
 
     std::vector<std::unique_ptr<ISel::Root>> m_roots; // pass is owner of roots
 };
@@ -1,22 +1,41 @@
 #pragma once
 
+#include "codegen/compilation_cache.hpp"
 #include "codegen/fixup.hpp"
 #include "codegen/instruction_encoder.hpp"
+#include "codegen/object_file_options.hpp"
+#include "IR/global_value.hpp"
 #include "pass.hpp"
 #include "target/instruction_info.hpp"
 #include "target/register_info.hpp"
 
 namespace scbe::Codegen {
 
+// Where a data entry ends up in the object file
+enum class DataSection {
+    Data,
+    ReadOnly,
+    // read only but needs relocations (jump tables, pointers to other symbols), the loader has to patch it
+    RelocatedReadOnly,
+    // a single null terminated string the linker may merge with identical ones
+    Strings,
+    // all zero and writable, takes no space in the file
+    Zero,
+};
+
 struct DataEntry {
     size_t m_loc;
-    MIR::GlobalAddress* m_globalAddress;
+    size_t m_size;
+    IR::Linkage m_linkage;
+    DataSection m_section = DataSection::Data;
 };
 
 class ObjectEmitter : public MachineFunctionPass {
 public: 
-    ObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info) : m_encoder(encoder), m_instructionInfo(info), m_registerInfo(info->getRegisterInfo()), m_output(output) {}
+    ObjectEmitter(std::ofstream& output, Ref<InstructionEncoder> encoder, Target::InstructionInfo* info, Ref<CompilationCache> cache = nullptr, ObjectFileOptions options = {})
+        : m_encoder(encoder), m_cache(cache), m_options(options), m_instructionInfo(info), m_registerInfo(info->getRegisterInfo()), m_output(output) {}
 
+    const char* getName() const override { return "object-emitter"; }
     bool run(MIR::Function* function) override;
     void end(Unit& unit) override;
     void init(Unit& unit) override;
@@ -25,14 +44,25 @@ public:
 
     virtual void emitObjectFile(Unit& unit) = 0;
 
+protected:
+    void resolveLocalFixups(MIR::Function* function, size_t codeStart, size_t fixupStart, const UMap<std::string, size_t>& symbols);
+    CachedFunction createCacheEntry(MIR::Function* function, size_t codeStart, size_t fixupStart);
+    void spliceCachedFunction(Unit& unit, IR::Function* function, const CachedFunction& entry);
+    DataSection classifyData(size_t loc, size_t size, bool readOnly, bool string, bool relocated) const;
+
 protected:
     Ref<InstructionEncoder> m_encoder = nullptr;
+    Ref<CompilationCache> m_cache = nullptr;
+    ObjectFileOptions m_options;
 
     std::vector<uint8_t> m_codeBytes;
     std::vector<uint8_t> m_dataBytes;
 
     std::vector<Fixup> m_fixups;
+    // function start offsets, blocks are resolved per function and never stored here
     UMap<std::string, size_t> m_codeLocTable;
+    // data fixups pointing at a block, rewritten against their function once it is encoded
+    UMap<std::string, std::vector<size_t>> m_blockDataFixups;
     UMap<std::string, DataEntry> m_dataLocTable;
 
     Target::InstructionInfo* m_instructionInfo;
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace scbe::Codegen {
+
+// Section layout knobs for object file output, only honored by the ELF emitter
+struct ObjectFileOptions {
+    // every function gets its own .text.<name> section so the linker can garbage collect it
+    bool m_functionSections = false;
+    // every global gets its own .data.<name> section
+    bool m_dataSections = false;
+    // external functions are put in a COMDAT group keyed by their name, implies function sections
+    bool m_comdat = false;
+};
+
+}
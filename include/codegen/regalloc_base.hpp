@@ -25,6 +25,7 @@ public:
     virtual void analyze(MIR::Function* function) = 0;
     virtual void end(MIR::Function* function) = 0;
 
+    const char* getName() const override { return "regalloc"; }
     bool run(MIR::Function* function) override;
     void processSpills(MIR::Function* function);
 
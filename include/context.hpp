@@ -5,6 +5,8 @@
 #include "IR/value.hpp"
 #include "MIR/operand.hpp"
 
+#include <map>
+#include <tuple>
 #include <vector>
 
 namespace scbe {
@@ -42,6 +44,8 @@ public:
     IR::ConstantFloat* getConstantFloat(uint8_t bits, double value);
     IR::ConstantStruct* getConstantStruct(StructType* type, const std::vector<IR::Constant*>& values);
     IR::ConstantArray* getConstantArray(ArrayType* type, const std::vector<IR::Constant*>& values);
+    IR::ConstantDataArray* getConstantDataArray(ArrayType* type, std::vector<uint8_t> data);
+    IR::ConstantAggregateZero* getConstantAggregateZero(Type* type);
     IR::ConstantGEP* getConstantGEP(IR::Constant* base, const std::vector<IR::ConstantInt*>& indices);
     IR::UndefValue* getUndefValue(Type* type);    
     IR::NullValue* getNullValue(Type* type);    
@@ -59,12 +63,14 @@ private:
     UMap<size_t, PointerType*> m_pointerCache;
     UMap<size_t, FunctionType*> m_functionCache;
 
-    UMap<size_t, IR::ConstantInt*> m_constantIntCache;
-    UMap<size_t, IR::ConstantFloat*> m_constantFloatCache;
+    // constants are keyed by their values, equal hashes of different values must not share a constant
+    std::map<std::pair<uint8_t, int64_t>, IR::ConstantInt*> m_constantIntCache;
+    std::map<std::pair<uint8_t, uint64_t>, IR::ConstantFloat*> m_constantFloatCache;
     UMap<Type*, IR::UndefValue*> m_undefValueCache;
     UMap<Type*, IR::NullValue*> m_nullValueCache;
+    UMap<Type*, IR::ConstantAggregateZero*> m_aggregateZeroCache;
 
-    UMap<size_t, MIR::ImmediateInt*> m_immediateIntCache;
+    std::map<std::tuple<int64_t, MIR::ImmediateInt::Size, int64_t>, MIR::ImmediateInt*> m_immediateIntCache;
 
 friend class IR::Module;
 };
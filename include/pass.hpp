@@ -29,6 +29,7 @@ public:
     virtual ~Pass() = default;
 
     Kind getKind() const { return m_kind; }
+    virtual const char* getName() const = 0;
 
     virtual void init(Unit& unit) {}
     virtual void end(Unit& unit) {}
@@ -2,6 +2,8 @@
 
 #include "pass.hpp"
 
+#include <functional>
+#include <string>
 #include <vector>
 
 namespace scbe {
@@ -17,8 +19,19 @@ public:
 
     void run(Unit& unit);
 
+    // Accumulates wall time per pass name, in order of first execution
+    void setTimePasses(bool timePasses) { m_timePasses = timePasses; }
+    const std::vector<std::pair<std::string, double>>& getPassTimings() const { return m_timings; }
+    void setAfterPassCallback(std::function<void(Pass*, Unit&)> callback) { m_afterPass = std::move(callback); }
+
+protected:
+    void runPass(Pass* pass, Unit& unit, bool& anyChange);
+
 protected:
     std::vector<PassGroup> m_groups;
+    bool m_timePasses = false;
+    std::vector<std::pair<std::string, double>> m_timings;
+    std::function<void(Pass*, Unit&)> m_afterPass;
 };
 
 }
\ No newline at end of file
@@ -23,4 +23,24 @@ inline std::string escapeString(const std::string& input) {
     return escaped;
 }
 
+// assemblers only know a few escapes and read digits after \0 as octal, so anything unprintable is three octal digits
+inline std::string escapeAssemblyString(const std::string& input) {
+    std::string escaped;
+    for (char c : input) {
+        unsigned char byte = c;
+        if (c == '\\' || c == '\"') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (byte >= 0x20 && byte < 0x7f) escaped += c;
+        else {
+            escaped += '\\';
+            escaped += (char)('0' + (byte >> 6));
+            escaped += (char)('0' + ((byte >> 3) & 7));
+            escaped += (char)('0' + (byte & 7));
+        }
+    }
+    return escaped;
+}
+
 }
\ No newline at end of file
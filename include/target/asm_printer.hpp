@@ -21,6 +21,7 @@ public:
     AsmPrinter(std::ofstream& output, InstructionInfo* instructionInfo, RegisterInfo* registerInfo, DataLayout* dataLayout, TargetSpecification spec)
         : m_output(output), m_instructionInfo(instructionInfo), m_registerInfo(registerInfo), m_dataLayout(dataLayout), m_spec(spec) {}
 
+    const char* getName() const override { return "asm-printer"; }
     bool run(MIR::Function* function) override;
 
     virtual void print(MIR::Function* function) = 0;
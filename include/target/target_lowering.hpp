@@ -22,6 +22,7 @@ protected:
     TargetLowering(RegisterInfo* registerInfo, InstructionInfo* instructionInfo, DataLayout* dataLayout, TargetSpecification spec, OptimizationLevel optLevel, Ref<Context> ctx)
         : MachineFunctionPass(), m_registerInfo(registerInfo), m_instructionInfo(instructionInfo), m_dataLayout(dataLayout), m_spiller(dataLayout, instructionInfo, registerInfo), m_targetSpec(spec), m_optLevel(optLevel), m_ctx(ctx) {}
 
+    const char* getName() const override { return "target-lowering"; }
     virtual bool run(MIR::Function* function);
 
     virtual MIR::CallInstruction* lowerCall(MIR::Block* block, MIR::CallLowering* instruction) = 0;
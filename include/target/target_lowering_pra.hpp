@@ -12,6 +12,7 @@ public:
     TargetLoweringPRA(RegisterInfo* registerInfo, InstructionInfo* instructionInfo, DataLayout* dataLayout, Ref<Context> ctx)
         : MachineFunctionPass(), m_registerInfo(registerInfo), m_instructionInfo(instructionInfo), m_dataLayout(dataLayout), m_ctx(ctx) {}
 
+    const char* getName() const override { return "target-lowering-pra"; }
     virtual bool run(MIR::Function* function);
 
     virtual void lowerIntrinsic(MIR::Block* block, MIR::IntrinsicLowering* instruction) = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "codegen/object_file_options.hpp"
 #include "data_layout.hpp"
 #include "pass_manager.hpp"
 #include "target/instruction_info.hpp"
@@ -12,6 +13,10 @@ namespace scbe {
 class Context;
 }
 
+namespace scbe::Codegen {
+class CompilationCache;
+}
+
 namespace scbe::Target {
 
     enum class FileType {
@@ -27,6 +32,13 @@ public:
 
     TargetSpecification getTargetSpecification() const { return m_spec; }
 
+    // Only used when emitting object files, assembly output always goes through the whole pipeline
+    void setCompilationCache(Ref<Codegen::CompilationCache> cache) { m_cache = cache; }
+    Ref<Codegen::CompilationCache> getCompilationCache() const { return m_cache; }
+
+    void setObjectFileOptions(Codegen::ObjectFileOptions options) { m_objectFileOptions = options; }
+    const Codegen::ObjectFileOptions& getObjectFileOptions() const { return m_objectFileOptions; }
+
     virtual void addPassesForCodeGeneration(Ref<PassManager> passManager, std::ofstream& output, FileType type, OptimizationLevel level) = 0;
     virtual void addPassesForCodeGeneration(Ref<PassManager> passManager, std::initializer_list<std::reference_wrapper<std::ofstream>> files, std::initializer_list<FileType> type, OptimizationLevel level) = 0;
     virtual DataLayout* getDataLayout() = 0;
@@ -36,6 +48,8 @@ public:
 protected:
     TargetSpecification m_spec;
     Ref<Context> m_context = nullptr;
+    Ref<Codegen::CompilationCache> m_cache = nullptr;
+    Codegen::ObjectFileOptions m_objectFileOptions;
 };
 
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ public:
     x64Legalizer(Ref<Context> context, TargetSpecification spec) : m_context(context), m_spec(spec) {}
 
     virtual void init(Unit& unit) override;
+    const char* getName() const override { return "x64-legalizer"; }
     virtual bool run(IR::Instruction* instruction) override;
 
 private:
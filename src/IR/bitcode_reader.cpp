@@ -0,0 +1,509 @@
+#include "IR/bitcode_reader.hpp"
+#include "IR/bitcode_format.hpp"
+#include "IR/block.hpp"
+#include "IR/function.hpp"
+#include "IR/global_value.hpp"
+#include "IR/instruction.hpp"
+#include "cast.hpp"
+#include "context.hpp"
+#include "type.hpp"
+#include "unit.hpp"
+
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace scbe::IR {
+
+using namespace Bitcode;
+
+// values and types come from the file, so they are checked before being used as what the writer would have put there
+template<typename T, typename U>
+static T* checkedCast(U* value, const char* what) {
+    T* result = dyn_cast<T>(value);
+    if(!result) throw std::runtime_error(std::string("Malformed bitcode: expected ") + what);
+    return result;
+}
+
+BitcodeReader::BitcodeReader(const std::string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("Could not open " + path);
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat " + path);
+    }
+    m_size = st.st_size;
+    if(m_size > 0) {
+        m_mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(m_mapping == MAP_FAILED) {
+            m_mapping = nullptr;
+            close(fd);
+            throw std::runtime_error("Could not map " + path);
+        }
+    }
+    close(fd);
+    m_data = (const uint8_t*)m_mapping;
+#else
+    std::ifstream is(path, std::ios::binary);
+    if(!is) throw std::runtime_error("Could not open " + path);
+    m_buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+    readHeader();
+}
+
+BitcodeReader::BitcodeReader(std::vector<uint8_t> buffer) : m_buffer(std::move(buffer)) {
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    readHeader();
+}
+
+BitcodeReader::~BitcodeReader() {
+#ifndef _WIN32
+    if(m_mapping) munmap(m_mapping, m_size);
+#endif
+}
+
+void BitcodeReader::readHeader() {
+    Cursor cursor(m_data, m_data + m_size);
+    if(cursor.readFixed(4) != s_magic) throw std::runtime_error("Not a bitcode file");
+    uint64_t version = cursor.readFixed(4);
+    if(version != s_version) throw std::runtime_error("Unsupported bitcode version " + std::to_string(version));
+    m_unitName = cursor.readString();
+    m_sections = cursor.getCurrent();
+}
+
+void BitcodeReader::readInto(Unit& unit) {
+    if(m_unit) throw std::runtime_error("Bitcode was already read");
+    m_unit = &unit;
+    Ref<Context> ctx = unit.getContext();
+    Cursor cursor(m_sections, m_data + m_size);
+
+    uint64_t typeCount = cursor.readCount();
+    m_types.reserve(typeCount);
+    for(uint64_t i = 0; i < typeCount; i++) {
+        Type::TypeKind kind = cursor.readEnum<Type::TypeKind>((uint64_t)Type::TypeKind::Function + 1, "type kind");
+        if(kind == Type::TypeKind::Struct) {
+            m_types.push_back(ctx->makeStructType({}, cursor.readString()));
+            continue;
+        }
+
+        uint64_t extra = 0;
+        if(kind == Type::TypeKind::Integer || kind == Type::TypeKind::Float || kind == Type::TypeKind::Array || kind == Type::TypeKind::Function)
+            extra = cursor.readVarint();
+        std::vector<Type*> contained(cursor.readCount());
+        for(auto& type : contained) type = getType(cursor.readVarint());
+        if((kind == Type::TypeKind::Pointer || kind == Type::TypeKind::Array || kind == Type::TypeKind::Function) && (contained.empty() || !contained.at(0)))
+            throw std::runtime_error("Malformed bitcode: missing element type");
+
+        switch(kind) {
+            case Type::TypeKind::Integer: m_types.push_back(ctx->getIntegerType(extra)); break;
+            case Type::TypeKind::Float: m_types.push_back(ctx->getFloatType(extra)); break;
+            case Type::TypeKind::Void: m_types.push_back(ctx->getVoidType()); break;
+            case Type::TypeKind::Pointer: m_types.push_back(ctx->makePointerType(contained.at(0))); break;
+            case Type::TypeKind::Array: m_types.push_back(ctx->makeArrayType(contained.at(0), extra)); break;
+            case Type::TypeKind::Function: {
+                Type* returnType = contained.at(0);
+                contained.erase(contained.begin());
+                m_types.push_back(ctx->makeFunctionType(contained, returnType, extra));
+                break;
+            }
+            default: throw std::runtime_error("Malformed bitcode: unknown type kind");
+        }
+    }
+
+    uint64_t structCount = cursor.readCount();
+    for(uint64_t i = 0; i < structCount; i++) {
+        uint64_t index = cursor.readVarint();
+        if(index >= m_types.size()) throw std::runtime_error("Malformed bitcode: type out of bounds");
+        StructType* type = checkedCast<StructType>(m_types.at(index), "struct type");
+        std::vector<Type*> elements(cursor.readCount());
+        for(auto& element : elements) element = getType(cursor.readVarint());
+        ctx->updateStructType(type, elements);
+    }
+
+    uint64_t constantCount = cursor.readCount(4);
+    std::vector<uint64_t> offsets(constantCount + 1);
+    for(auto& offset : offsets) offset = cursor.readFixed(4);
+    const uint8_t* entries = cursor.getCurrent();
+    if(offsets.back() > (uint64_t)(m_data + m_size - entries)) throw std::runtime_error("Malformed bitcode: constants out of bounds");
+    for(uint64_t i = 0; i < constantCount; i++) {
+        if(offsets.at(i) > offsets.back()) throw std::runtime_error("Malformed bitcode: constants out of bounds");
+        m_constantEntries.push_back(entries + offsets.at(i));
+    }
+    m_constants.resize(constantCount, nullptr);
+    cursor = Cursor(entries + offsets.back(), m_data + m_size);
+
+    uint64_t globalCount = cursor.readCount();
+    for(uint64_t i = 0; i < globalCount; i++) {
+        GlobalRecord record;
+        record.m_name = cursor.readString();
+        record.m_type = cursor.readVarint();
+        record.m_linkage = (uint64_t)cursor.readEnum<Linkage>((uint64_t)Linkage::Internal + 1, "linkage");
+        record.m_flags = cursor.readVarint();
+        record.m_value = cursor.readVarint();
+        m_globalRecords.push_back(std::move(record));
+    }
+    m_globals.resize(globalCount, nullptr);
+
+    // functions are declared before any constant is materialized, globals may point to them
+    uint64_t functionCount = cursor.readCount();
+    for(uint64_t i = 0; i < functionCount; i++) {
+        std::string name = cursor.readString();
+        Type* type = getType(cursor.readVarint());
+        Linkage linkage = cursor.readEnum<Linkage>((uint64_t)Linkage::Internal + 1, "linkage");
+        // Count is a function that doesn't override the target's convention
+        CallingConvention callConv = cursor.readEnum<CallingConvention>((uint64_t)CallingConvention::Count + 1, "calling convention");
+        uint64_t intrinsic = cursor.readEnum<uint64_t>((uint64_t)IntrinsicName::Count + 1, "intrinsic");
+        if(!type || !type->isFuncType()) throw std::runtime_error("Malformed bitcode: expected function type for " + name);
+
+        Function* function = intrinsic ? unit.getOrInsertFunction((IntrinsicName)(intrinsic - 1)) : unit.getOrInsertFunction(name, cast<FunctionType>(type), linkage);
+        function->setCallingConvention(callConv);
+
+        uint64_t argCount = cursor.readVarint();
+        if(argCount != function->getArguments().size()) throw std::runtime_error("Malformed bitcode: argument count mismatch for " + name);
+        for(auto& arg : function->getArguments()) {
+            std::string argName = cursor.readString();
+            if(!argName.empty()) arg->setName(argName);
+            arg->setFlags(cursor.readVarint());
+        }
+        m_functions.push_back(function);
+    }
+
+    for(Function* function : m_functions) {
+        BodyRecord record;
+        record.m_offset = cursor.readFixed(8);
+        record.m_size = cursor.readFixed(8);
+        if(record.m_offset > m_size || record.m_size > m_size - record.m_offset) throw std::runtime_error("Malformed bitcode: body of " + function->getName() + " out of bounds");
+        if(record.m_size > 0) m_bodies[function] = record;
+    }
+
+    for(uint64_t i = 0; i < globalCount; i++)
+        getGlobal(i);
+}
+
+Type* BitcodeReader::getType(uint64_t reference) {
+    if(reference == 0) return nullptr;
+    if(reference > m_types.size()) throw std::runtime_error("Malformed bitcode: type out of bounds");
+    return m_types.at(reference - 1);
+}
+
+GlobalVariable* BitcodeReader::getGlobal(uint64_t index) {
+    if(index >= m_globals.size()) throw std::runtime_error("Malformed bitcode: global out of bounds");
+    if(m_globals.at(index)) return m_globals.at(index);
+    if(m_globalsInProgress.contains(index)) throw std::runtime_error("Global " + m_globalRecords.at(index).m_name + " has a cyclic initializer");
+
+    m_globalsInProgress.insert(index);
+    const GlobalRecord& record = m_globalRecords.at(index);
+    Type* type = getType(record.m_type);
+    if(!type) throw std::runtime_error("Malformed bitcode: global " + record.m_name + " without a type");
+    Constant* value = record.m_value ? getConstant(record.m_value - 1) : nullptr;
+    m_globals[index] = m_unit->getOrInsertGlobalVariable(type, value, (Linkage)record.m_linkage, record.m_name);
+    m_globals.at(index)->setReadOnly(record.m_flags & 1);
+    m_globalsInProgress.erase(index);
+    return m_globals.at(index);
+}
+
+Constant* BitcodeReader::getConstant(uint64_t index) {
+    if(index >= m_constants.size()) throw std::runtime_error("Malformed bitcode: constant out of bounds");
+    if(m_constants.at(index)) return m_constants.at(index);
+
+    Ref<Context> ctx = m_unit->getContext();
+    if(m_constantsInProgress.contains(index)) throw std::runtime_error("Malformed bitcode: cyclic constant");
+    m_constantsInProgress.insert(index);
+
+    Cursor cursor(m_constantEntries.at(index), m_data + m_size);
+    Value::ValueKind kind = cursor.readEnum<Value::ValueKind>((uint64_t)Value::ValueKind::FunctionArgument + 1, "constant kind");
+    Type* type = getType(cursor.readVarint());
+    Constant* constant = nullptr;
+
+    switch(kind) {
+        case Value::ValueKind::ConstantInt:
+            constant = ctx->getConstantInt(checkedCast<IntegerType>(type, "integer type")->getBits(), cursor.readSigned());
+            break;
+        case Value::ValueKind::ConstantFloat: {
+            uint64_t bits = cursor.readFixed(8);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            constant = ctx->getConstantFloat(checkedCast<FloatType>(type, "float type")->getBits(), value);
+            break;
+        }
+        case Value::ValueKind::ConstantStruct:
+        case Value::ValueKind::ConstantArray: {
+            std::vector<Constant*> values(cursor.readCount());
+            for(auto& value : values) value = getConstant(cursor.readVarint());
+            if(kind == Value::ValueKind::ConstantStruct) {
+                StructType* structType = checkedCast<StructType>(type, "struct type");
+                if(values.size() != structType->getContainedTypes().size()) throw std::runtime_error("Malformed bitcode: struct constant size mismatch");
+                for(size_t i = 0; i < values.size(); i++)
+                    if(values.at(i)->getType() != structType->getContainedTypes().at(i)) throw std::runtime_error("Malformed bitcode: struct constant type mismatch");
+                constant = ctx->getConstantStruct(structType, values);
+            }
+            else {
+                ArrayType* arrayType = checkedCast<ArrayType>(type, "array type");
+                for(auto value : values)
+                    if(value->getType() != arrayType->getElement()) throw std::runtime_error("Malformed bitcode: array constant type mismatch");
+                constant = ctx->getConstantArray(arrayType, values);
+            }
+            break;
+        }
+        case Value::ValueKind::ConstantDataArray: {
+            ArrayType* arrayType = dyn_cast<ArrayType>(type);
+            std::vector<uint8_t> data = cursor.readBytes();
+            if(!arrayType || (!arrayType->getElement()->isIntType() && !arrayType->getElement()->isFltType()))
+                throw std::runtime_error("Malformed bitcode: data array of invalid type");
+            Type* element = arrayType->getElement();
+            size_t elementSize = element->isFltType() ? cast<FloatType>(element)->getBits() / 8 : std::max<size_t>(1, cast<IntegerType>(element)->getBits() / 8);
+            if(data.size() != arrayType->getScale() * elementSize) throw std::runtime_error("Malformed bitcode: data array size mismatch");
+            constant = ctx->getConstantDataArray(arrayType, std::move(data));
+            break;
+        }
+        case Value::ValueKind::ConstantAggregateZero:
+            if(!type || (!type->isStructType() && !type->isArrayType())) throw std::runtime_error("Malformed bitcode: zeroinitializer of non aggregate type");
+            constant = ctx->getConstantAggregateZero(type);
+            break;
+        case Value::ValueKind::ConstantGEP: {
+            Constant* base = getConstant(cursor.readVarint());
+            if(!base->getType()->isPtrType() && !base->getType()->isArrayType()) throw std::runtime_error("Malformed bitcode: constant gep of a non pointer");
+            std::vector<ConstantInt*> indices(cursor.readCount());
+            for(auto& gepIndex : indices) gepIndex = checkedCast<ConstantInt>(getConstant(cursor.readVarint()), "constant integer index");
+            constant = ctx->getConstantGEP(base, indices);
+            break;
+        }
+        case Value::ValueKind::GlobalVariable:
+            constant = getGlobal(cursor.readVarint());
+            break;
+        case Value::ValueKind::Function: {
+            uint64_t functionIndex = cursor.readVarint();
+            if(functionIndex >= m_functions.size()) throw std::runtime_error("Malformed bitcode: function out of bounds");
+            constant = m_functions.at(functionIndex);
+            break;
+        }
+        case Value::ValueKind::UndefValue:
+            if(!type) throw std::runtime_error("Malformed bitcode: undef without a type");
+            constant = ctx->getUndefValue(type);
+            break;
+        case Value::ValueKind::NullValue:
+            if(!type) throw std::runtime_error("Malformed bitcode: null without a type");
+            constant = ctx->getNullValue(type);
+            break;
+        default:
+            throw std::runtime_error("Malformed bitcode: unknown constant kind");
+    }
+
+    m_constantsInProgress.erase(index);
+    m_constants[index] = constant;
+    return constant;
+}
+
+bool BitcodeReader::isMaterializable(Function* function) const {
+    return m_bodies.contains(function) && !m_bodies.at(function).m_materialized;
+}
+
+void BitcodeReader::materializeAll() {
+    for(Function* function : m_functions)
+        if(isMaterializable(function)) materialize(function);
+}
+
+void BitcodeReader::materialize(Function* function) {
+    if(!isMaterializable(function)) return;
+    BodyRecord& body = m_bodies.at(function);
+    body.m_materialized = true;
+    Cursor cursor(m_data + body.m_offset, m_data + body.m_offset + body.m_size);
+
+    struct InstructionRecord {
+        Instruction::Opcode m_opcode;
+        Type* m_type;
+        std::string m_name;
+        int64_t m_flags;
+        CallingConvention m_callConv = CallingConvention::Count;
+        std::vector<std::pair<OperandTag, uint64_t>> m_operands;
+    };
+
+    std::vector<Block*> blocks(cursor.readCount());
+    std::vector<uint64_t> blockSizes;
+    for(auto& block : blocks) {
+        // block names get a counter appended on insertion, strip the old one so names don't keep growing
+        std::string name = cursor.readString();
+        while(!name.empty() && name.back() >= '0' && name.back() <= '9') name.pop_back();
+        block = function->insertBlock(name);
+        blockSizes.push_back(cursor.readCount());
+    }
+
+    std::vector<InstructionRecord> records;
+    for(uint64_t size : blockSizes) {
+        for(uint64_t i = 0; i < size; i++) {
+            InstructionRecord record;
+            record.m_opcode = cursor.readEnum<Instruction::Opcode>((uint64_t)Instruction::Opcode::Count, "opcode");
+            record.m_type = getType(cursor.readVarint());
+            record.m_name = cursor.readString();
+            record.m_flags = cursor.readVarint();
+            if(record.m_opcode == Instruction::Opcode::Call)
+                record.m_callConv = cursor.readEnum<CallingConvention>((uint64_t)CallingConvention::Count + 1, "calling convention");
+            record.m_operands.resize(cursor.readCount(2));
+            for(auto& operand : record.m_operands) {
+                operand.first = (OperandTag)cursor.readByte();
+                if(operand.first > OperandTag::Constant) throw std::runtime_error("Malformed bitcode: unknown operand tag");
+                operand.second = cursor.readVarint();
+            }
+            records.push_back(std::move(record));
+        }
+    }
+
+    std::vector<std::unique_ptr<Instruction>> instructions(records.size());
+
+    auto resolve = [&](const std::pair<OperandTag, uint64_t>& operand) -> Value* {
+        switch(operand.first) {
+            case OperandTag::Argument:
+                if(operand.second >= function->getArguments().size()) break;
+                return function->getArguments().at(operand.second).get();
+            case OperandTag::Instruction:
+                if(operand.second >= instructions.size()) break;
+                return instructions.at(operand.second).get();
+            case OperandTag::Block:
+                if(operand.second >= blocks.size()) break;
+                return blocks.at(operand.second);
+            case OperandTag::Constant:
+                return getConstant(operand.second);
+        }
+        throw std::runtime_error("Malformed bitcode: bad operand in " + function->getName());
+    };
+
+    auto create = [&](const InstructionRecord& record) -> std::unique_ptr<Instruction> {
+        std::vector<Value*> ops;
+        if(record.m_opcode != Instruction::Opcode::Phi)
+            for(auto& operand : record.m_operands) ops.push_back(resolve(operand));
+        auto expect = [&](size_t count) {
+            if(ops.size() < count) throw std::runtime_error("Malformed bitcode: missing operands in " + function->getName());
+        };
+        // what the instruction constructors assert on, a file can't be trusted to get it right
+        auto require = [&](bool condition, const char* what) {
+            if(!condition) throw std::runtime_error(std::string("Malformed bitcode: ") + what + " in " + function->getName());
+        };
+        auto hasKind = [](Value* value, Type::TypeKind kind) {
+            return value->getType() && value->getType()->getKind() == kind;
+        };
+
+        switch(record.m_opcode) {
+            case Instruction::Opcode::Ret:
+                return std::make_unique<ReturnInstruction>(ops.empty() ? nullptr : ops.at(0));
+            case Instruction::Opcode::Allocate: {
+                if(!record.m_type) throw std::runtime_error("Malformed bitcode: allocation without a type in " + function->getName());
+                auto allocate = std::make_unique<AllocateInstruction>(record.m_type, record.m_name);
+                for(auto op : ops) allocate->addOperand(op);
+                return allocate;
+            }
+            case Instruction::Opcode::Load:
+                expect(1);
+                require(hasKind(ops.at(0), Type::TypeKind::Pointer), "load from a non pointer");
+                return std::make_unique<LoadInstruction>(ops.at(0), record.m_name);
+            case Instruction::Opcode::Store:
+                expect(2);
+                require(hasKind(ops.at(0), Type::TypeKind::Pointer), "store to a non pointer");
+                require(ops.at(1)->getType() && !ops.at(1)->isConstantArray() && !ops.at(1)->isConstantStruct() && !ops.at(1)->isConstantDataArray() && !ops.at(1)->isConstantAggregateZero(), "bad stored value");
+                return std::make_unique<StoreInstruction>(ops.at(0), ops.at(1));
+            case Instruction::Opcode::Jump:
+                expect(1);
+                if(ops.size() == 1) return std::make_unique<JumpInstruction>(checkedCast<Block>(ops.at(0), "block"));
+                expect(3);
+                return std::make_unique<JumpInstruction>(checkedCast<Block>(ops.at(0), "block"), checkedCast<Block>(ops.at(1), "block"), ops.at(2));
+            case Instruction::Opcode::Phi:
+                return std::make_unique<PhiInstruction>(record.m_type, record.m_name);
+            case Instruction::Opcode::GetElementPtr:
+                expect(1);
+                for(size_t i = 1; i < ops.size(); i++) require(hasKind(ops.at(i), Type::TypeKind::Integer), "non integer gep index");
+                return std::make_unique<GEPInstruction>(record.m_type, ops.at(0), std::vector<Value*>(ops.begin() + 1, ops.end()), record.m_name);
+            case Instruction::Opcode::Call: {
+                expect(1);
+                auto call = std::make_unique<CallInstruction>(record.m_type, ops.at(0), std::vector<Value*>(ops.begin() + 1, ops.end()), record.m_name);
+                call->setCallingConvention(record.m_callConv);
+                return call;
+            }
+            case Instruction::Opcode::Switch: {
+                expect(2);
+                std::vector<std::pair<ConstantInt*, Block*>> cases;
+                for(size_t i = 2; i + 1 < ops.size(); i += 2)
+                    cases.push_back({checkedCast<ConstantInt>(ops.at(i), "constant integer case"), checkedCast<Block>(ops.at(i + 1), "block")});
+                return std::make_unique<SwitchInstruction>(ops.at(0), checkedCast<Block>(ops.at(1), "block"), cases);
+            }
+            case Instruction::Opcode::ExtractValue: {
+                expect(2);
+                ConstantInt* extractIndex = checkedCast<ConstantInt>(ops.at(1), "constant integer index");
+                require(hasKind(ops.at(0), Type::TypeKind::Struct) && extractIndex->getValue() >= 0 && (size_t)extractIndex->getValue() < ops.at(0)->getType()->getContainedTypes().size(), "bad extractvalue");
+                return std::make_unique<ExtractValueInstruction>(ops.at(0), extractIndex, record.m_name);
+            }
+            default:
+                if(record.m_opcode >= Instruction::Opcode::Zext && record.m_opcode <= Instruction::Opcode::Inttoptr) {
+                    expect(1);
+                    require(ops.at(0)->getType() && record.m_type, "untyped cast");
+                    return std::make_unique<CastInstruction>(record.m_opcode, ops.at(0), record.m_type, record.m_name);
+                }
+                expect(2);
+                require(ops.at(0)->getType() && ops.at(0)->getType() == ops.at(1)->getType(), "operand type mismatch");
+                return std::make_unique<BinaryOperator>(record.m_opcode, ops.at(0), ops.at(1), record.m_type, record.m_name);
+        }
+    };
+
+    // values can be used in blocks that come before their definition, so instructions are created in dependency order.
+    // phis are created empty first, they are the only way to form cycles
+    for(size_t i = 0; i < records.size(); i++)
+        if(records.at(i).m_opcode == Instruction::Opcode::Phi) instructions[i] = create(records.at(i));
+
+    std::vector<std::pair<size_t, size_t>> stack;
+    USet<size_t> visiting;
+    for(size_t root = 0; root < records.size(); root++) {
+        if(instructions.at(root)) continue;
+        stack.push_back({root, 0});
+        visiting.insert(root);
+        while(!stack.empty()) {
+            auto& [current, next] = stack.back();
+            const InstructionRecord& record = records.at(current);
+            if(next < record.m_operands.size()) {
+                auto operand = record.m_operands.at(next++);
+                if(operand.first != OperandTag::Instruction || operand.second >= records.size() || instructions.at(operand.second)) continue;
+                if(visiting.contains(operand.second)) throw std::runtime_error("Malformed bitcode: cyclic definition in " + function->getName());
+                visiting.insert(operand.second);
+                stack.push_back({operand.second, 0});
+                continue;
+            }
+            instructions[current] = create(record);
+            instructions[current]->setFlags(record.m_flags);
+            visiting.erase(current);
+            stack.pop_back();
+        }
+    }
+
+    std::vector<std::pair<PhiInstruction*, size_t>> phis;
+    size_t index = 0;
+    for(size_t b = 0; b < blocks.size(); b++) {
+        for(uint64_t i = 0; i < blockSizes.at(b); i++, index++) {
+            if(records.at(index).m_opcode == Instruction::Opcode::Phi) phis.push_back({cast<PhiInstruction>(instructions.at(index).get()), index});
+            blocks.at(b)->addInstruction(std::move(instructions.at(index)));
+        }
+    }
+
+    // everything is owned by the blocks now, resolve through the phis' new home
+    std::vector<Instruction*> placed;
+    for(auto& block : blocks)
+        for(auto& instruction : block->getInstructions()) placed.push_back(instruction.get());
+    for(auto& [phi, recordIndex] : phis) {
+        phi->setFlags(records.at(recordIndex).m_flags);
+        for(auto& operand : records.at(recordIndex).m_operands) {
+            if(operand.first == OperandTag::Instruction) {
+                if(operand.second >= placed.size()) throw std::runtime_error("Malformed bitcode: bad operand in " + function->getName());
+                phi->addOperand(placed.at(operand.second));
+            }
+            else phi->addOperand(resolve(operand));
+        }
+    }
+}
+
+}
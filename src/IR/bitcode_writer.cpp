@@ -0,0 +1,255 @@
+#include "IR/bitcode_writer.hpp"
+#include "IR/bitcode_format.hpp"
+#include "IR/block.hpp"
+#include "IR/function.hpp"
+#include "IR/global_value.hpp"
+#include "IR/instruction.hpp"
+#include "IR/intrinsic.hpp"
+#include "cast.hpp"
+#include "type.hpp"
+#include "unit.hpp"
+
+namespace scbe::IR {
+
+using namespace Bitcode;
+
+static bool isGeneratedName(const std::string& name) {
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+void BitcodeWriter::write(Unit& unit) {
+    for(size_t i = 0; i < unit.getGlobals().size(); i++)
+        m_globalIndices[unit.getGlobals().at(i).get()] = i;
+    for(size_t i = 0; i < unit.getFunctions().size(); i++)
+        m_functionIndices[unit.getFunctions().at(i).get()] = i;
+
+    std::vector<uint8_t> globals;
+    writeVarint(globals, unit.getGlobals().size());
+    for(auto& global : unit.getGlobals()) {
+        writeString(globals, global->getName());
+        writeVarint(globals, getTypeIndex(global->getType()));
+        writeVarint(globals, (uint64_t)global->getLinkage());
+        writeVarint(globals, global->isReadOnly() ? 1 : 0);
+        writeVarint(globals, global->getValue() ? getConstantIndex(global->getValue()) + 1 : 0);
+    }
+
+    std::vector<uint8_t> functionRecords;
+    writeVarint(functionRecords, unit.getFunctions().size());
+    for(auto& function : unit.getFunctions()) {
+        writeString(functionRecords, function->getName());
+        writeVarint(functionRecords, getTypeIndex(function->getFunctionType()));
+        writeVarint(functionRecords, (uint64_t)function->getLinkage());
+        writeVarint(functionRecords, (uint64_t)function->getCallingConvention());
+        writeVarint(functionRecords, function->isIntrinsic() ? (uint64_t)cast<IntrinsicFunction>(function.get())->getIntrinsicName() + 1 : 0);
+        writeVarint(functionRecords, function->getArguments().size());
+        for(auto& arg : function->getArguments()) {
+            writeString(functionRecords, isGeneratedName(arg->getName()) ? "" : arg->getName());
+            writeVarint(functionRecords, arg->getFlags());
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> bodies;
+    for(auto& function : unit.getFunctions()) {
+        bodies.emplace_back();
+        if(function->hasBody()) writeFunctionBody(bodies.back(), function.get());
+    }
+
+    // types and constants are only complete once every body was visited
+    std::vector<uint8_t> types;
+    writeVarint(types, m_typeCount);
+    types.insert(types.end(), m_types.begin(), m_types.end());
+    writeVarint(types, m_structs.size());
+    for(StructType* structType : m_structs) {
+        writeVarint(types, m_typeIndices.at(structType));
+        writeVarint(types, structType->getContainedTypes().size());
+        for(auto element : structType->getContainedTypes())
+            writeVarint(types, getTypeIndex(element));
+    }
+
+    std::vector<uint8_t> constants;
+    writeVarint(constants, m_constants.size());
+    uint64_t offset = 0;
+    for(auto& constant : m_constants) {
+        writeFixed(constants, offset, 4);
+        offset += constant.size();
+    }
+    writeFixed(constants, offset, 4);
+    for(auto& constant : m_constants)
+        constants.insert(constants.end(), constant.begin(), constant.end());
+
+    std::vector<uint8_t> header;
+    writeFixed(header, s_magic, 4);
+    writeFixed(header, s_version, 4);
+    writeString(header, unit.getName());
+
+    // the body table has fixed size entries, so body offsets are known before writing it
+    uint64_t bodyOffset = header.size() + types.size() + constants.size() + globals.size() + functionRecords.size() + unit.getFunctions().size() * 16;
+
+    std::vector<uint8_t> bodyTable;
+    for(auto& body : bodies) {
+        writeFixed(bodyTable, body.empty() ? 0 : bodyOffset, 8);
+        writeFixed(bodyTable, body.size(), 8);
+        bodyOffset += body.size();
+    }
+
+    for(auto* section : {&header, &types, &constants, &globals, &functionRecords, &bodyTable})
+        m_output.write((const char*)section->data(), section->size());
+    for(auto& body : bodies)
+        m_output.write((const char*)body.data(), body.size());
+}
+
+uint64_t BitcodeWriter::getTypeIndex(Type* type) {
+    if(!type) return 0;
+    if(m_typeIndices.contains(type)) return m_typeIndices.at(type) + 1;
+
+    // structs get their index before the elements are visited, everything else after,
+    // so the reader can create types in order and fill in struct bodies at the end
+    if(type->isStructType()) {
+        m_typeIndices[type] = m_typeCount++;
+        writeVarint(m_types, (uint64_t)type->getKind());
+        writeString(m_types, cast<StructType>(type)->getName());
+        m_structs.push_back(cast<StructType>(type));
+        for(auto element : type->getContainedTypes())
+            getTypeIndex(element);
+        return m_typeIndices.at(type) + 1;
+    }
+
+    std::vector<uint64_t> contained;
+    for(auto element : type->getContainedTypes())
+        contained.push_back(getTypeIndex(element));
+
+    m_typeIndices[type] = m_typeCount++;
+    writeVarint(m_types, (uint64_t)type->getKind());
+    switch(type->getKind()) {
+        case Type::TypeKind::Integer:
+            writeVarint(m_types, cast<IntegerType>(type)->getBits());
+            break;
+        case Type::TypeKind::Float:
+            writeVarint(m_types, cast<FloatType>(type)->getBits());
+            break;
+        case Type::TypeKind::Array:
+            writeVarint(m_types, cast<ArrayType>(type)->getScale());
+            break;
+        case Type::TypeKind::Function:
+            writeVarint(m_types, cast<FunctionType>(type)->isVarArg());
+            break;
+        default:
+            break;
+    }
+    writeVarint(m_types, contained.size());
+    for(uint64_t index : contained)
+        writeVarint(m_types, index);
+    return m_typeIndices.at(type) + 1;
+}
+
+uint64_t BitcodeWriter::getConstantIndex(Constant* constant) {
+    if(m_constantIndices.contains(constant)) return m_constantIndices.at(constant);
+
+    std::vector<uint8_t> entry;
+    writeVarint(entry, (uint64_t)constant->getKind());
+    writeVarint(entry, getTypeIndex(constant->getType()));
+
+    switch(constant->getKind()) {
+        case Value::ValueKind::ConstantInt:
+            writeSigned(entry, cast<ConstantInt>(constant)->getValue());
+            break;
+        case Value::ValueKind::ConstantFloat: {
+            double value = cast<ConstantFloat>(constant)->getValue();
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            writeFixed(entry, bits, 8);
+            break;
+        }
+        case Value::ValueKind::ConstantStruct:
+        case Value::ValueKind::ConstantArray: {
+            ConstantMultiple* multiple = cast<ConstantMultiple>(constant);
+            writeVarint(entry, multiple->getValues().size());
+            for(auto element : multiple->getValues())
+                writeVarint(entry, getConstantIndex(element));
+            break;
+        }
+        case Value::ValueKind::ConstantDataArray: {
+            const std::vector<uint8_t>& data = cast<ConstantDataArray>(constant)->getData();
+            writeString(entry, std::string_view((const char*)data.data(), data.size()));
+            break;
+        }
+        case Value::ValueKind::ConstantAggregateZero:
+            break;
+        case Value::ValueKind::ConstantGEP: {
+            ConstantGEP* gep = cast<ConstantGEP>(constant);
+            writeVarint(entry, getConstantIndex(gep->getBase()));
+            writeVarint(entry, gep->getIndices().size());
+            for(auto index : gep->getIndices())
+                writeVarint(entry, getConstantIndex(index));
+            break;
+        }
+        case Value::ValueKind::GlobalVariable:
+            writeVarint(entry, m_globalIndices.at(cast<GlobalVariable>(constant)));
+            break;
+        case Value::ValueKind::Function:
+            writeVarint(entry, m_functionIndices.at(cast<Function>(constant)));
+            break;
+        case Value::ValueKind::UndefValue:
+        case Value::ValueKind::NullValue:
+            break;
+        default:
+            throw std::runtime_error("Cannot serialize constant of this kind");
+    }
+
+    m_constantIndices[constant] = m_constants.size();
+    m_constants.push_back(std::move(entry));
+    return m_constantIndices.at(constant);
+}
+
+void BitcodeWriter::writeFunctionBody(std::vector<uint8_t>& out, Function* function) {
+    UMap<Value*, uint64_t> locals;
+    UMap<Value*, uint64_t> blocks;
+    for(auto& arg : function->getArguments())
+        locals[arg.get()] = arg->getSlot();
+
+    writeVarint(out, function->getBlocks().size());
+    uint64_t instructionIndex = 0;
+    for(auto& block : function->getBlocks()) {
+        blocks[block.get()] = blocks.size();
+        writeString(out, block->getName());
+        writeVarint(out, block->getInstructions().size());
+        for(auto& instruction : block->getInstructions())
+            locals[instruction.get()] = instructionIndex++;
+    }
+
+    for(auto& block : function->getBlocks()) {
+        for(auto& instruction : block->getInstructions()) {
+            writeVarint(out, (uint64_t)instruction->getOpcode());
+            writeVarint(out, getTypeIndex(instruction->getType()));
+            writeString(out, isGeneratedName(instruction->getName()) ? "" : instruction->getName());
+            writeVarint(out, instruction->getFlags());
+            if(instruction->getOpcode() == Instruction::Opcode::Call)
+                writeVarint(out, (uint64_t)cast<CallInstruction>(instruction.get())->getCallingConvention());
+
+            writeVarint(out, instruction->getNumOperands());
+            for(auto operand : instruction->getOperands())
+                writeOperand(out, operand, locals, blocks);
+        }
+    }
+}
+
+void BitcodeWriter::writeOperand(std::vector<uint8_t>& out, Value* value, const UMap<Value*, uint64_t>& locals, const UMap<Value*, uint64_t>& blocks) {
+    if(value->isFunctionArgument()) {
+        out.push_back((uint8_t)OperandTag::Argument);
+        writeVarint(out, locals.at(value));
+    }
+    else if(value->isRegister()) {
+        out.push_back((uint8_t)OperandTag::Instruction);
+        writeVarint(out, locals.at(value));
+    }
+    else if(value->isBlock()) {
+        out.push_back((uint8_t)OperandTag::Block);
+        writeVarint(out, blocks.at(value));
+    }
+    else {
+        out.push_back((uint8_t)OperandTag::Constant);
+        writeVarint(out, getConstantIndex(cast<Constant>(value)));
+    }
+}
+
+}
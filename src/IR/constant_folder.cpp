@@ -16,6 +16,9 @@ bool ConstantFolder::run(IR::Instruction* instruction) {
     else if(auto binOp = dyn_cast<IR::BinaryOperator>(instruction)) {
         result = m_folder.foldBinOp(binOp->getOpcode(), binOp->getLHS(), binOp->getRHS());
     }
+    else if(auto load = dyn_cast<IR::LoadInstruction>(instruction)) {
+        result = m_folder.foldLoad(load->getPointer());
+    }
     else if(auto jmp = dyn_cast<IR::JumpInstruction>(instruction)) {
         if(jmp->getNumOperands() < 3) return false;
 
@@ -1,4 +1,5 @@
 #include "IR/folder.hpp"
+#include "IR/global_value.hpp"
 #include "IR/instruction.hpp"
 #include "IR/value.hpp"
 #include "cast.hpp"
@@ -39,6 +40,65 @@ Value* Folder::foldCast(Instruction::Opcode opcode, Value* value, Type* type) {
     return nullptr;
 }
 
+Value* Folder::foldLoad(Value* ptr) {
+    Value* base = ptr;
+    std::vector<Value*> indices;
+    if(auto gep = dyn_cast<GEPInstruction>(ptr)) {
+        base = gep->getPointer();
+        indices.assign(gep->getOperands().begin() + 1, gep->getOperands().end());
+    }
+    else if(auto gep = dyn_cast<ConstantGEP>(ptr)) {
+        base = gep->getBase();
+        indices.assign(gep->getIndices().begin(), gep->getIndices().end());
+    }
+
+    GlobalVariable* global = dyn_cast<GlobalVariable>(base);
+    if(!global || !global->isReadOnly() || !global->getValue()) return nullptr;
+
+    // the first index steps over whole globals, anything but 0 is outside of it
+    Constant* current = global->getValue();
+    for(size_t i = 0; i < indices.size(); i++) {
+        ConstantInt* index = dyn_cast<ConstantInt>(indices.at(i));
+        if(!index) return nullptr;
+        if(i == 0) {
+            if(index->getValue() != 0) return nullptr;
+            continue;
+        }
+        current = getElement(current, index->getValue());
+        if(!current) return nullptr;
+    }
+
+    Type* loaded = cast<PointerType>(ptr->getType())->getPointee();
+    if(current->getType() != loaded) return nullptr;
+    if(!current->isConstantInt() && !current->isConstantFloat() && !current->isNullValue()) return nullptr;
+    return current;
+}
+
+Constant* Folder::getElement(Constant* aggregate, int64_t index) {
+    if(index < 0) return nullptr;
+    switch(aggregate->getKind()) {
+        case Value::ValueKind::ConstantArray:
+        case Value::ValueKind::ConstantStruct: {
+            ConstantMultiple* multiple = cast<ConstantMultiple>(aggregate);
+            if((size_t)index >= multiple->getValues().size()) return nullptr;
+            return multiple->getValues().at(index);
+        }
+        case Value::ValueKind::ConstantDataArray: {
+            ConstantDataArray* data = cast<ConstantDataArray>(aggregate);
+            if((size_t)index >= data->getNumElements()) return nullptr;
+            return data->getElementAsConstant(index, m_context);
+        }
+        case Value::ValueKind::ConstantAggregateZero: {
+            Type* type = aggregate->getType();
+            if(type->isStructType() && (size_t)index >= type->getContainedTypes().size()) return nullptr;
+            if(type->isArrayType() && (size_t)index >= cast<ArrayType>(type)->getScale()) return nullptr;
+            return cast<ConstantAggregateZero>(aggregate)->getElement(index, nullptr, m_context);
+        }
+        default:
+            return nullptr;
+    }
+}
+
 template<typename T, typename F>
 Value* Folder::foldBinOpInternal(Instruction::Opcode opcode, T* lhs, T* rhs, std::function<T*(F)> constructor) {
     switch (opcode) {
@@ -0,0 +1,839 @@
+#include "IR/parser.hpp"
+#include "IR/block.hpp"
+#include "IR/function.hpp"
+#include "IR/global_value.hpp"
+#include "IR/intrinsic.hpp"
+#include "cast.hpp"
+#include "context.hpp"
+#include "type.hpp"
+#include "unit.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+namespace scbe::IR {
+
+static bool isNameChar(char c) {
+    return std::isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$';
+}
+
+static bool isNumericName(const std::string& name) {
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+static std::optional<IntrinsicName> getIntrinsicName(const std::string& name) {
+    static const std::pair<const char*, IntrinsicName> intrinsics[] = {
+        {".intrinsic.memcpy", IntrinsicName::Memcpy},
+        {".intrinsic.va_start", IntrinsicName::VaStart},
+        {".intrinsic.va_end", IntrinsicName::VaEnd},
+        {".intrinsic.stack_get", IntrinsicName::StackGet},
+        {".intrinsic.stack_set", IntrinsicName::StackSet},
+    };
+    for(auto& [intrinsicName, intrinsic] : intrinsics)
+        if(name == intrinsicName) return intrinsic;
+    return std::nullopt;
+}
+
+static const UMap<std::string, Instruction::Opcode>& getOpcodes() {
+    static UMap<std::string, Instruction::Opcode> opcodes;
+    if(opcodes.empty()) {
+        for(size_t i = 0; i < (size_t)Instruction::Opcode::Count; i++) {
+            std::string name = Instruction::opcodeString((Instruction::Opcode)i);
+            if(!name.empty()) opcodes[name] = (Instruction::Opcode)i;
+        }
+    }
+    return opcodes;
+}
+
+Parser::Parser(std::string source, Ref<Context> context, std::string fileName) : m_source(std::move(source)), m_fileName(std::move(fileName)), m_context(context) {}
+
+void Parser::tokenize() {
+    uint32_t line = 1;
+    size_t lineStart = 0;
+    size_t i = 0;
+    auto push = [&](Token::Kind kind, std::string text, size_t start) {
+        m_tokens.push_back({kind, std::move(text), line, (uint32_t)(start - lineStart + 1)});
+    };
+
+    while(i < m_source.size()) {
+        char c = m_source[i];
+        if(c == '\n') {
+            line++;
+            lineStart = ++i;
+            continue;
+        }
+        if(std::isspace((unsigned char)c)) {
+            i++;
+            continue;
+        }
+        if(c == '/' && i + 1 < m_source.size() && m_source[i + 1] == '/') {
+            while(i < m_source.size() && m_source[i] != '\n') i++;
+            continue;
+        }
+
+        size_t start = i;
+        if(c == '%' || c == '@') {
+            i++;
+            while(i < m_source.size() && isNameChar(m_source[i])) i++;
+            push(c == '%' ? Token::Kind::Local : Token::Kind::Global, m_source.substr(start + 1, i - start - 1), start);
+            continue;
+        }
+
+        bool negative = c == '-' && i + 1 < m_source.size() && (std::isdigit((unsigned char)m_source[i + 1]) || m_source.compare(i + 1, 3, "inf") == 0 || m_source.compare(i + 1, 3, "nan") == 0);
+        if(std::isdigit((unsigned char)c) || negative) {
+            i++;
+            while(i < m_source.size()) {
+                char n = m_source[i];
+                bool exponentSign = (n == '+' || n == '-') && (m_source[i - 1] == 'e' || m_source[i - 1] == 'E');
+                if(!std::isalnum((unsigned char)n) && n != '.' && !exponentSign) break;
+                i++;
+            }
+            push(Token::Kind::Number, m_source.substr(start, i - start), start);
+            continue;
+        }
+
+        if(isNameChar(c)) {
+            while(i < m_source.size() && isNameChar(m_source[i])) i++;
+            push(Token::Kind::Identifier, m_source.substr(start, i - start), start);
+            continue;
+        }
+
+        if(c == '"') {
+            std::string value;
+            i++;
+            while(true) {
+                if(i >= m_source.size()) {
+                    push(Token::Kind::End, "", start);
+                    error("unterminated string", m_tokens.size() - 1);
+                }
+                char s = m_source[i++];
+                if(s == '"') break;
+                if(s != '\\' || i >= m_source.size()) {
+                    if(s == '\n') {
+                        line++;
+                        lineStart = i;
+                    }
+                    value += s;
+                    continue;
+                }
+                switch(m_source[i++]) {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    case 'a': value += '\a'; break;
+                    case 'b': value += '\b'; break;
+                    case 'f': value += '\f'; break;
+                    case 'v': value += '\v'; break;
+                    case '0': value += '\0'; break;
+                    default: value += m_source[i - 1]; break;
+                }
+            }
+            push(Token::Kind::String, std::move(value), start);
+            continue;
+        }
+
+        if(c == '-' && i + 1 < m_source.size() && m_source[i + 1] == '>') {
+            i += 2;
+            push(Token::Kind::Punctuation, "->", start);
+            continue;
+        }
+        if(std::string("(){}[],*=:;").find(c) == std::string::npos) {
+            push(Token::Kind::Punctuation, std::string(1, c), start);
+            error(std::string("unexpected character '") + c + "'", m_tokens.size() - 1);
+        }
+        i++;
+        push(Token::Kind::Punctuation, std::string(1, c), start);
+    }
+    push(Token::Kind::End, "", i);
+}
+
+const Parser::Token& Parser::peek(size_t offset) const {
+    return m_tokens.at(std::min(m_current + offset, m_tokens.size() - 1));
+}
+
+const Parser::Token& Parser::next() {
+    const Token& token = peek();
+    if(token.m_kind != Token::Kind::End) m_current++;
+    return token;
+}
+
+bool Parser::check(const std::string& punctuation, size_t offset) const {
+    const Token& token = peek(offset);
+    return (token.m_kind == Token::Kind::Punctuation || token.m_kind == Token::Kind::Identifier) && token.m_text == punctuation;
+}
+
+bool Parser::accept(const std::string& punctuation) {
+    if(!check(punctuation)) return false;
+    m_current++;
+    return true;
+}
+
+void Parser::expect(const std::string& punctuation) {
+    if(!accept(punctuation)) error("expected '" + punctuation + "'", m_current);
+}
+
+std::string Parser::expectIdentifier() {
+    if(peek().m_kind != Token::Kind::Identifier && peek().m_kind != Token::Kind::Number) error("expected identifier", m_current);
+    return next().m_text;
+}
+
+void Parser::error(const std::string& message, size_t token) const {
+    const Token& at = m_tokens.at(std::min(token, m_tokens.size() - 1));
+    std::string found = at.m_kind == Token::Kind::End ? "end of file" : "'" + at.m_text + "'";
+    throw std::runtime_error(m_fileName + ":" + std::to_string(at.m_line) + ":" + std::to_string(at.m_column) + ": " + message + ", found " + found);
+}
+
+std::unique_ptr<Unit> Parser::parse() {
+    tokenize();
+    m_current = 0;
+
+    if(!check("Unit")) error("expected 'Unit'", m_current);
+    next();
+    m_unit = std::make_unique<Unit>(expectIdentifier(), m_context);
+
+    // declarations first, so bodies and initializers can refer to anything in the file
+    while(peek().m_kind != Token::Kind::End) {
+        size_t start = m_current;
+        accept("internal");
+        if(check("global")) {
+            m_current = start;
+            skipGlobal();
+        }
+        else if(check("fn") || check("extern")) {
+            m_current = start;
+            parseFunctionHeader();
+        }
+        else if(m_current == start && peek().m_kind == Token::Kind::Identifier && check("{", 1))
+            parseStructDefinition();
+        else
+            error("expected a global, function or struct definition", m_current);
+    }
+
+    for(size_t declaration : m_globalDeclarations)
+        getGlobal(declaration);
+
+    for(auto& [function, body] : m_bodies) {
+        m_current = body;
+        parseFunctionBody(function);
+    }
+    return std::move(m_unit);
+}
+
+void Parser::parseStructDefinition() {
+    size_t token = m_current;
+    std::string name = next().m_text;
+    expect("{");
+    std::vector<Type*> elements;
+    if(!check("}")) {
+        do elements.push_back(parseType());
+        while(accept(","));
+    }
+    expect("}");
+    expect(";");
+
+    if(!m_structs.contains(name)) m_structs[name] = m_context->makeStructType({}, name);
+    else if(!m_structs.at(name)->getContainedTypes().empty()) error("redefinition of struct " + name, token);
+    m_context->updateStructType(m_structs.at(name), elements);
+}
+
+void Parser::parseFunctionHeader() {
+    Linkage linkage = accept("internal") ? Linkage::Internal : Linkage::External;
+    bool external = accept("extern");
+    expect("fn");
+    size_t nameToken = m_current;
+    std::string name = expectIdentifier();
+    if(m_functions.contains(name)) error("redefinition of function " + name, nameToken);
+
+    expect("(");
+    std::vector<Type*> params;
+    std::vector<std::string> argNames;
+    bool varArg = false;
+    if(!check(")")) {
+        do {
+            if(accept("...")) {
+                varArg = true;
+                break;
+            }
+            params.push_back(parseType());
+            if(peek().m_kind != Token::Kind::Local) error("expected argument name", m_current);
+            argNames.push_back(next().m_text);
+        } while(accept(","));
+    }
+    expect(")");
+    expect("->");
+    Type* returnType = parseType();
+
+    Function* function = nullptr;
+    if(auto intrinsic = getIntrinsicName(name)) {
+        function = m_unit->getOrInsertFunction(*intrinsic);
+        if(function->getFunctionType() != m_context->makeFunctionType(params, returnType, varArg)) error("wrong signature for intrinsic " + name, nameToken);
+    }
+    else {
+        function = m_unit->getOrInsertFunction(name, m_context->makeFunctionType(params, returnType, varArg), linkage);
+        for(size_t i = 0; i < argNames.size(); i++)
+            if(!isNumericName(argNames.at(i))) function->getArguments().at(i)->setName(argNames.at(i));
+    }
+    m_functions[name] = function;
+
+    if(external) {
+        expect(";");
+        return;
+    }
+
+    // bodies are parsed once every declaration is known, just find the end here
+    if(!check("{")) error("expected '{'", m_current);
+    m_bodies.push_back({function, m_current});
+    size_t depth = 0;
+    do {
+        if(peek().m_kind == Token::Kind::End) error("unterminated function body", m_current);
+        if(check("{")) depth++;
+        else if(check("}")) depth--;
+        next();
+    } while(depth > 0);
+}
+
+void Parser::skipGlobal() {
+    m_globalDeclarations.push_back(m_current);
+    accept("internal");
+    expect("global");
+    if(accept("(")) {
+        if(!accept("anonymous")) error("expected 'anonymous'", m_current);
+        expect(")");
+    }
+    else {
+        size_t token = m_current;
+        std::string name = expectIdentifier();
+        if(m_globalNames.contains(name)) error("redefinition of global " + name, token);
+        m_globalNames[name] = m_globalDeclarations.back();
+    }
+    accept("constant");
+    parseType();
+    if(!accept("=")) return;
+
+    // the initializer may refer to globals that don't exist yet, it is parsed when the global is created
+    skipConstant();
+}
+
+void Parser::skipConstant() {
+    parseType();
+    if(accept("const")) {
+        expect("getelementptr");
+        skipConstant();
+    }
+    else if(!check("{")) {
+        next();
+        return;
+    }
+    expect("{");
+    if(!check("}")) {
+        do skipConstant();
+        while(accept(","));
+    }
+    expect("}");
+}
+
+GlobalVariable* Parser::getGlobal(size_t declaration) {
+    if(m_globals.contains(declaration)) return m_globals.at(declaration);
+    if(m_globalsInProgress.contains(declaration)) error("global has a cyclic initializer", declaration);
+    m_globalsInProgress.insert(declaration);
+
+    size_t saved = m_current;
+    m_current = declaration;
+    Linkage linkage = accept("internal") ? Linkage::Internal : Linkage::External;
+    expect("global");
+    std::string name;
+    if(accept("(")) {
+        next();
+        next();
+    }
+    else name = next().m_text;
+    bool readOnly = accept("constant");
+    Type* type = parseType();
+    Constant* value = accept("=") ? parseConstant() : nullptr;
+    m_current = saved;
+
+    m_globals[declaration] = m_unit->getOrInsertGlobalVariable(type, value, linkage, name);
+    m_globals.at(declaration)->setReadOnly(readOnly);
+    m_globalsInProgress.erase(declaration);
+    return m_globals.at(declaration);
+}
+
+Type* Parser::parseType() {
+    size_t token = m_current;
+    if(peek().m_kind != Token::Kind::Identifier) error("expected type", token);
+    std::string name = next().m_text;
+
+    Type* type = nullptr;
+    if(name == "void") type = m_context->getVoidType();
+    else if((name[0] == 'i' || name[0] == 'f') && isNumericName(name.substr(1))) {
+        int bits = std::atoi(name.c_str() + 1);
+        if(name[0] == 'i') {
+            if(bits != 1 && bits != 8 && bits != 16 && bits != 32 && bits != 64) error("unsupported integer width", token);
+            type = m_context->getIntegerType(bits);
+        }
+        else {
+            if(bits != 32 && bits != 64) error("unsupported float width", token);
+            type = m_context->getFloatType(bits);
+        }
+    }
+    else {
+        if(!m_structs.contains(name)) m_structs[name] = m_context->makeStructType({}, name);
+        type = m_structs.at(name);
+    }
+
+    while(true) {
+        if(accept("*"))
+            type = m_context->makePointerType(type);
+        else if(accept("[")) {
+            if(peek().m_kind != Token::Kind::Number) error("expected array size", m_current);
+            type = m_context->makeArrayType(type, std::strtoul(next().m_text.c_str(), nullptr, 10));
+            expect("]");
+        }
+        else if(accept("(")) {
+            std::vector<Type*> params;
+            bool varArg = false;
+            if(!check(")")) {
+                do {
+                    if(accept("...")) {
+                        varArg = true;
+                        break;
+                    }
+                    params.push_back(parseType());
+                } while(accept(","));
+            }
+            expect(")");
+            type = m_context->makeFunctionType(params, type, varArg);
+        }
+        else break;
+    }
+    return type;
+}
+
+Constant* Parser::parseConstant() {
+    size_t token = m_current;
+    return parseConstant(parseType(), token);
+}
+
+Constant* Parser::parseConstant(Type* type, size_t token) {
+    size_t valueToken = m_current;
+    const Token& value = peek();
+
+    if(value.m_kind == Token::Kind::Number) {
+        next();
+        if(type->isIntType()) {
+            errno = 0;
+            char* end = nullptr;
+            int64_t integer = value.m_text[0] == '-' ? std::strtoll(value.m_text.c_str(), &end, 10) : (int64_t)std::strtoull(value.m_text.c_str(), &end, 10);
+            if(errno != 0 || *end != '\0') error("invalid integer", valueToken);
+            return m_context->getConstantInt(cast<IntegerType>(type)->getBits(), integer);
+        }
+        if(type->isFltType()) {
+            char* end = nullptr;
+            double number = std::strtod(value.m_text.c_str(), &end);
+            if(*end != '\0') error("invalid float", valueToken);
+            return m_context->getConstantFloat(cast<FloatType>(type)->getBits(), number);
+        }
+        error("numeric constant of non numeric type", valueToken);
+    }
+
+    if(value.m_kind == Token::Kind::String) {
+        next();
+        ArrayType* arrayType = dyn_cast<ArrayType>(type);
+        if(!arrayType || arrayType->getElement() != m_context->getI8Type()) error("string constant of non i8 array type", token);
+        if(arrayType->getScale() != value.m_text.size()) error("string length does not match array size", valueToken);
+        return m_context->getConstantDataArray(arrayType, std::vector<uint8_t>(value.m_text.begin(), value.m_text.end()));
+    }
+
+    if(value.m_kind == Token::Kind::Global) {
+        next();
+        if(!m_globalNames.contains(value.m_text)) error("undefined global @" + value.m_text, valueToken);
+        GlobalVariable* global = getGlobal(m_globalNames.at(value.m_text));
+        if(global->getType() != type) error("type mismatch for @" + value.m_text, token);
+        return global;
+    }
+
+    if(accept("undef")) return m_context->getUndefValue(type);
+    if(accept("null")) return m_context->getNullValue(type);
+    if(accept("zeroinitializer")) {
+        if(!type->isStructType() && !type->isArrayType()) error("zeroinitializer of non aggregate type", token);
+        return m_context->getConstantAggregateZero(type);
+    }
+
+    if(accept("const")) {
+        expect("getelementptr");
+        size_t baseToken = m_current;
+        Constant* base = parseConstant();
+        if(!base->getType()->isPtrType() && !base->getType()->isArrayType()) error("expected pointer or array", baseToken);
+        expect("{");
+        std::vector<ConstantInt*> indices;
+        Type* current = base->getType();
+        if(!check("}")) {
+            do {
+                size_t indexToken = m_current;
+                ConstantInt* index = dyn_cast<ConstantInt>(parseConstant());
+                if(!index) error("expected integer index", indexToken);
+                size_t element = current->isArrayType() || current->isPtrType() ? 0 : index->getValue();
+                if(element >= current->getContainedTypes().size()) error("index out of range", indexToken);
+                current = current->getContainedTypes().at(element);
+                indices.push_back(index);
+            } while(accept(","));
+        }
+        expect("}");
+        ConstantGEP* gep = m_context->getConstantGEP(base, indices);
+        if(gep->getType() != type) error("type mismatch for constant getelementptr", token);
+        return gep;
+    }
+
+    if(accept("{")) {
+        std::vector<Constant*> values;
+        if(!check("}")) {
+            do values.push_back(parseConstant());
+            while(accept(","));
+        }
+        expect("}");
+        if(StructType* structType = dyn_cast<StructType>(type)) {
+            if(values.size() != structType->getContainedTypes().size()) error("wrong number of struct elements", valueToken);
+            return m_context->getConstantStruct(structType, values);
+        }
+        if(ArrayType* arrayType = dyn_cast<ArrayType>(type)) {
+            if(values.size() != arrayType->getScale()) error("wrong number of array elements", valueToken);
+            for(Constant* element : values)
+                if(element->getType() != arrayType->getElement()) error("array element type mismatch", valueToken);
+            bool packed = std::all_of(values.begin(), values.end(), [](Constant* value) { return value->isConstantInt() || value->isConstantFloat(); });
+            if(packed && !values.empty()) return ConstantDataArray::get(arrayType, values, m_context);
+            return m_context->getConstantArray(arrayType, values);
+        }
+        error("aggregate constant of non aggregate type", token);
+    }
+
+    if(value.m_kind == Token::Kind::Identifier) {
+        next();
+        if(!m_functions.contains(value.m_text)) error("undefined function " + value.m_text, valueToken);
+        Function* function = m_functions.at(value.m_text);
+        if(function->getFunctionType() != type) error("type mismatch for function " + value.m_text, token);
+        return function;
+    }
+
+    error("expected value", valueToken);
+}
+
+Parser::Operand Parser::parseOperand() {
+    Operand operand;
+    operand.m_token = m_current;
+    operand.m_type = parseType();
+    if(peek().m_kind == Token::Kind::Local) {
+        operand.m_name = next().m_text;
+        if(m_arguments.contains(operand.m_name)) {
+            operand.m_kind = Operand::Kind::Value;
+            operand.m_value = m_arguments.at(operand.m_name);
+            if(operand.m_value->getType() != operand.m_type) error("type mismatch for %" + operand.m_name, operand.m_token);
+        }
+        else operand.m_kind = Operand::Kind::Local;
+        return operand;
+    }
+    operand.m_kind = Operand::Kind::Value;
+    operand.m_value = parseConstant(operand.m_type, operand.m_token);
+    return operand;
+}
+
+Parser::Operand Parser::parseBlockOperand() {
+    Operand operand;
+    operand.m_kind = Operand::Kind::Block;
+    operand.m_token = m_current;
+    operand.m_name = expectIdentifier();
+    return operand;
+}
+
+std::vector<Parser::Operand> Parser::parseOperandList() {
+    std::vector<Operand> operands;
+    do operands.push_back(parseOperand());
+    while(accept(","));
+    return operands;
+}
+
+Parser::InstructionRecord Parser::parseInstruction() {
+    InstructionRecord record;
+    record.m_token = m_current;
+    if(peek().m_kind == Token::Kind::Local && check("=", 1)) {
+        record.m_name = next().m_text;
+        next();
+    }
+
+    size_t token = m_current;
+    auto expectOperands = [&](size_t count) {
+        if(record.m_operands.size() != count) error("expected " + std::to_string(count) + " operands", token);
+    };
+    auto typeOf = [&](size_t index) { return record.m_operands.at(index).m_type; };
+
+    const auto& opcodes = getOpcodes();
+    std::string keyword = peek().m_kind == Token::Kind::Identifier ? peek().m_text : "";
+    if(keyword == "icmp" || keyword == "ucmp" || keyword == "fcmp") {
+        next();
+        keyword += " " + expectIdentifier();
+        if(!opcodes.contains(keyword)) error("unknown comparison " + keyword, token);
+    }
+    else if(!opcodes.contains(keyword)) {
+        // casts are printed with their destination type first
+        record.m_type = parseType();
+        std::string cast = expectIdentifier();
+        if(!opcodes.contains(cast) || !(opcodes.at(cast) >= Instruction::Opcode::Zext && opcodes.at(cast) <= Instruction::Opcode::Inttoptr)) error("expected instruction", token);
+        record.m_opcode = opcodes.at(cast);
+        record.m_operands.push_back(parseOperand());
+        return record;
+    }
+    else next();
+    record.m_opcode = opcodes.at(keyword);
+
+    switch(record.m_opcode) {
+        case Instruction::Opcode::Allocate:
+            record.m_type = m_context->makePointerType(parseType());
+            if(accept(",")) {
+                record.m_operands.push_back(parseOperand());
+                if(!typeOf(0)->isIntType()) error("expected integer count", record.m_operands.at(0).m_token);
+            }
+            break;
+        case Instruction::Opcode::Ret:
+            // the returned value, if any, is on the same line
+            if(peek().m_line == m_tokens.at(token).m_line && !check("}")) record.m_operands.push_back(parseOperand());
+            if(!m_function->getFunctionType()->getReturnType()->isVoidType() && (record.m_operands.empty() || typeOf(0) != m_function->getFunctionType()->getReturnType()))
+                error("return type mismatch", token);
+            break;
+        case Instruction::Opcode::Jump:
+            record.m_operands.push_back(parseBlockOperand());
+            if(accept(",")) {
+                record.m_operands.push_back(parseBlockOperand());
+                expect(",");
+                record.m_operands.push_back(parseOperand());
+            }
+            break;
+        case Instruction::Opcode::Switch: {
+            record.m_operands.push_back(parseOperand());
+            if(!typeOf(0)->isIntType()) error("expected integer condition", record.m_operands.at(0).m_token);
+            record.m_operands.push_back(parseBlockOperand());
+            expect("{");
+            while(!accept("}")) {
+                Operand value = parseOperand();
+                if(value.m_kind != Operand::Kind::Value || !value.m_value->isConstantInt()) error("expected constant integer case", value.m_token);
+                record.m_operands.push_back(value);
+                expect("->");
+                record.m_operands.push_back(parseBlockOperand());
+            }
+            break;
+        }
+        case Instruction::Opcode::Phi:
+            do {
+                record.m_operands.push_back(parseOperand());
+                expect(",");
+                record.m_operands.push_back(parseBlockOperand());
+            } while(accept(","));
+            record.m_type = typeOf(0);
+            for(size_t i = 0; i < record.m_operands.size(); i += 2)
+                if(typeOf(i) != record.m_type) error("phi operand type mismatch", record.m_operands.at(i).m_token);
+            break;
+        case Instruction::Opcode::Call: {
+            record.m_operands.push_back(parseOperand());
+            FunctionType* fnType = dyn_cast<FunctionType>(typeOf(0));
+            if(!fnType && typeOf(0)->isPtrType()) fnType = dyn_cast<FunctionType>(cast<PointerType>(typeOf(0))->getPointee());
+            if(!fnType) error("expected function callee", token);
+            expect("(");
+            if(!check(")")) {
+                for(auto& arg : parseOperandList()) record.m_operands.push_back(arg);
+            }
+            expect(")");
+            size_t args = record.m_operands.size() - 1;
+            if(args < fnType->getArguments().size() || (args > fnType->getArguments().size() && !fnType->isVarArg())) error("wrong number of call arguments", token);
+            for(size_t i = 0; i < fnType->getArguments().size(); i++)
+                if(typeOf(i + 1) != fnType->getArguments()[i]) error("call argument type mismatch", record.m_operands.at(i + 1).m_token);
+            record.m_type = fnType->getReturnType();
+            break;
+        }
+        case Instruction::Opcode::Store:
+            record.m_operands = parseOperandList();
+            expectOperands(2);
+            if(!typeOf(0)->isPtrType() || cast<PointerType>(typeOf(0))->getPointee() != typeOf(1)) error("store type mismatch", token);
+            break;
+        case Instruction::Opcode::Load:
+            record.m_operands = parseOperandList();
+            expectOperands(1);
+            if(!typeOf(0)->isPtrType()) error("expected pointer operand", token);
+            record.m_type = cast<PointerType>(typeOf(0))->getPointee();
+            break;
+        case Instruction::Opcode::GetElementPtr: {
+            record.m_operands = parseOperandList();
+            Type* current = typeOf(0);
+            if(!current->isPtrType() && !current->isArrayType()) error("expected pointer or array operand", token);
+            for(size_t i = 1; i < record.m_operands.size(); i++) {
+                const Operand& index = record.m_operands.at(i);
+                if(!index.m_type->isIntType()) error("expected integer index", index.m_token);
+                bool sequential = current->isArrayType() || current->isPtrType();
+                if(!sequential && (index.m_kind != Operand::Kind::Value || !index.m_value->isConstantInt())) error("struct index must be constant", index.m_token);
+                size_t element = sequential ? 0 : cast<ConstantInt>(index.m_value)->getValue();
+                if(element >= current->getContainedTypes().size()) error("index out of range", index.m_token);
+                current = current->getContainedTypes().at(element);
+            }
+            record.m_type = m_context->makePointerType(current);
+            break;
+        }
+        case Instruction::Opcode::ExtractValue: {
+            record.m_operands = parseOperandList();
+            expectOperands(2);
+            const Operand& index = record.m_operands.at(1);
+            if(!typeOf(0)->isStructType()) error("expected struct operand", token);
+            if(index.m_kind != Operand::Kind::Value || !index.m_value->isConstantInt() || (size_t)cast<ConstantInt>(index.m_value)->getValue() >= typeOf(0)->getContainedTypes().size())
+                error("expected valid constant index", index.m_token);
+            record.m_type = typeOf(0)->getContainedTypes().at(cast<ConstantInt>(index.m_value)->getValue());
+            break;
+        }
+        default: {
+            if(record.m_opcode >= Instruction::Opcode::Zext && record.m_opcode <= Instruction::Opcode::Inttoptr) error("cast without destination type", token);
+            record.m_operands = parseOperandList();
+            expectOperands(2);
+            if(typeOf(0) != typeOf(1)) error("operand type mismatch", token);
+            Instruction::Opcode opcode = record.m_opcode;
+            record.m_type = opcode >= Instruction::Opcode::ICmpEq && opcode <= Instruction::Opcode::FCmpLe ? m_context->getI1Type() : typeOf(0);
+            break;
+        }
+    }
+    return record;
+}
+
+std::unique_ptr<Instruction> Parser::createInstruction(const InstructionRecord& record, const std::vector<Value*>& operands) {
+    std::string name = isNumericName(record.m_name) ? "" : record.m_name;
+    switch(record.m_opcode) {
+        case Instruction::Opcode::Allocate: {
+            auto allocate = std::make_unique<AllocateInstruction>(record.m_type, name);
+            if(!operands.empty()) allocate->addOperand(operands.at(0));
+            return allocate;
+        }
+        case Instruction::Opcode::Ret:
+            return std::make_unique<ReturnInstruction>(operands.empty() ? nullptr : operands.at(0));
+        case Instruction::Opcode::Jump:
+            if(operands.size() == 1) return std::make_unique<JumpInstruction>(cast<Block>(operands.at(0)));
+            return std::make_unique<JumpInstruction>(cast<Block>(operands.at(0)), cast<Block>(operands.at(1)), operands.at(2));
+        case Instruction::Opcode::Switch: {
+            std::vector<std::pair<ConstantInt*, Block*>> cases;
+            for(size_t i = 2; i + 1 < operands.size(); i += 2)
+                cases.push_back({cast<ConstantInt>(operands.at(i)), cast<Block>(operands.at(i + 1))});
+            return std::make_unique<SwitchInstruction>(operands.at(0), cast<Block>(operands.at(1)), cases);
+        }
+        case Instruction::Opcode::Phi:
+            return std::make_unique<PhiInstruction>(record.m_type, name);
+        case Instruction::Opcode::Call:
+            return std::make_unique<CallInstruction>(record.m_type, operands.at(0), std::vector<Value*>(operands.begin() + 1, operands.end()), name);
+        case Instruction::Opcode::Store:
+            return std::make_unique<StoreInstruction>(operands.at(0), operands.at(1));
+        case Instruction::Opcode::Load:
+            return std::make_unique<LoadInstruction>(operands.at(0), name);
+        case Instruction::Opcode::GetElementPtr:
+            return std::make_unique<GEPInstruction>(record.m_type, operands.at(0), std::vector<Value*>(operands.begin() + 1, operands.end()), name);
+        case Instruction::Opcode::ExtractValue:
+            return std::make_unique<ExtractValueInstruction>(operands.at(0), cast<ConstantInt>(operands.at(1)), name);
+        default:
+            if(record.m_opcode >= Instruction::Opcode::Zext && record.m_opcode <= Instruction::Opcode::Inttoptr)
+                return std::make_unique<CastInstruction>(record.m_opcode, operands.at(0), record.m_type, name);
+            return std::make_unique<BinaryOperator>(record.m_opcode, operands.at(0), operands.at(1), record.m_type, name);
+    }
+}
+
+void Parser::parseFunctionBody(Function* function) {
+    m_function = function;
+    m_arguments.clear();
+    for(auto& arg : function->getArguments())
+        m_arguments[arg->getName()] = arg.get();
+
+    expect("{");
+    std::vector<std::pair<std::string, size_t>> labels;
+    std::vector<InstructionRecord> records;
+    UMap<std::string, size_t> locals;
+    while(!accept("}")) {
+        if(peek().m_kind == Token::Kind::End) error("unterminated function body", m_current);
+        if(check(":", 1) && peek().m_kind != Token::Kind::Local) {
+            labels.push_back({next().m_text, m_current - 1});
+            next();
+            continue;
+        }
+        if(labels.empty()) error("expected block label", m_current);
+
+        InstructionRecord record = parseInstruction();
+        record.m_block = labels.size() - 1;
+        if(!record.m_name.empty()) {
+            if(locals.contains(record.m_name) || m_arguments.contains(record.m_name)) error("redefinition of %" + record.m_name, record.m_token);
+            locals[record.m_name] = records.size();
+        }
+        records.push_back(std::move(record));
+    }
+
+    UMap<std::string, Block*> blocks;
+    for(auto& [label, token] : labels) {
+        if(blocks.contains(label)) error("redefinition of block " + label, token);
+        // names get a counter appended on insertion, strip the printed one so they don't keep growing
+        std::string base = label;
+        while(!base.empty() && base.back() >= '0' && base.back() <= '9') base.pop_back();
+        blocks[label] = function->insertBlock(base);
+    }
+
+    std::vector<std::unique_ptr<Instruction>> instructions(records.size());
+    auto localIndex = [&](const Operand& operand) {
+        if(!locals.contains(operand.m_name)) error("undefined value %" + operand.m_name, operand.m_token);
+        size_t index = locals.at(operand.m_name);
+        if(records.at(index).m_type != operand.m_type) error("type mismatch for %" + operand.m_name, operand.m_token);
+        return index;
+    };
+    auto resolve = [&](const Operand& operand) -> Value* {
+        switch(operand.m_kind) {
+            case Operand::Kind::Value: return operand.m_value;
+            case Operand::Kind::Local: return instructions.at(localIndex(operand)).get();
+            case Operand::Kind::Block:
+                if(!blocks.contains(operand.m_name)) error("undefined block " + operand.m_name, operand.m_token);
+                return blocks.at(operand.m_name);
+        }
+        return nullptr;
+    };
+
+    // values can be used before their definition in block order, so instructions are created in dependency order.
+    // phis are created empty first, they are the only way to form cycles
+    for(size_t i = 0; i < records.size(); i++)
+        if(records.at(i).m_opcode == Instruction::Opcode::Phi) instructions[i] = createInstruction(records.at(i), {});
+
+    std::vector<std::pair<size_t, size_t>> stack;
+    USet<size_t> visiting;
+    for(size_t root = 0; root < records.size(); root++) {
+        if(instructions.at(root)) continue;
+        stack.push_back({root, 0});
+        visiting.insert(root);
+        while(!stack.empty()) {
+            auto& [current, nextOperand] = stack.back();
+            const InstructionRecord& record = records.at(current);
+            if(nextOperand < record.m_operands.size()) {
+                const Operand& operand = record.m_operands.at(nextOperand++);
+                if(operand.m_kind != Operand::Kind::Local) continue;
+                size_t dependency = localIndex(operand);
+                if(instructions.at(dependency)) continue;
+                if(visiting.contains(dependency)) error("value %" + operand.m_name + " depends on itself", operand.m_token);
+                visiting.insert(dependency);
+                stack.push_back({dependency, 0});
+                continue;
+            }
+            std::vector<Value*> operands;
+            for(auto& operand : record.m_operands) operands.push_back(resolve(operand));
+            instructions[current] = createInstruction(record, operands);
+            visiting.erase(current);
+            stack.pop_back();
+        }
+    }
+
+    std::vector<Instruction*> created;
+    for(auto& instruction : instructions) created.push_back(instruction.get());
+    for(size_t i = 0; i < records.size(); i++)
+        blocks.at(labels.at(records.at(i).m_block).first)->addInstruction(std::move(instructions.at(i)));
+
+    for(size_t i = 0; i < records.size(); i++) {
+        if(records.at(i).m_opcode != Instruction::Opcode::Phi) continue;
+        for(auto& operand : records.at(i).m_operands)
+            created.at(i)->addOperand(operand.m_kind == Operand::Kind::Local ? created.at(localIndex(operand)) : resolve(operand));
+    }
+    m_function = nullptr;
+}
+
+}
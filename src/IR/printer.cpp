@@ -5,6 +5,7 @@
 #include "printer_util.hpp"
 #include "type.hpp"
 #include "unit.hpp"
+#include <charconv>
 #include <ostream>
 
 namespace scbe::IR {
@@ -17,11 +18,12 @@ void HumanPrinter::print(Unit& unit) {
     m_output << "Unit " << unit.getName() << "\n\n";
 
     for(auto& global : unit.getGlobals()) {
+        if(global->getLinkage() == Linkage::Internal) m_output << "internal ";
         m_output << "global ";
         if(global->getName().empty()) m_output << "(anonymous) ";
         else m_output << global->getName() << " ";
 
-        if(global->isConstant()) m_output << "constant ";
+        if(global->isReadOnly()) m_output << "constant ";
 
         print(global->getType());
 
@@ -50,6 +52,8 @@ void HumanPrinter::print(Unit& unit) {
 }
 
 void HumanPrinter::print(const Function* function) {
+    if(function->getLinkage() == Linkage::Internal && !function->isIntrinsic())
+        m_output << "internal ";
     if(!function->hasBody()) {
         m_output << "extern ";
     }
@@ -177,7 +181,10 @@ void HumanPrinter::print(const Value* value) {
             print(value->getType());
             m_output << " ";
             auto constantFloat = (const ConstantFloat*)value;
-            m_output << constantFloat->getValue();
+            // shortest representation that reads back to the same value
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), constantFloat->getValue());
+            m_output << std::string_view(buffer, result.ptr - buffer);
             break;
         }
         case Value::ValueKind::ConstantStruct: {
@@ -215,6 +222,33 @@ void HumanPrinter::print(const Value* value) {
             m_output << " }";
             break;
         }
+        case Value::ValueKind::ConstantDataArray: {
+            print(value->getType());
+            auto dataArray = (const ConstantDataArray*)value;
+            auto elty = dataArray->getElementType();
+            if(elty->isIntType() && cast<IntegerType>(elty)->getBits() == 8) {
+                m_output << " \"" << escapeString(dataArray->getAsString()) << "\"";
+                break;
+            }
+            m_output << " { ";
+            for(size_t i = 0; i < dataArray->getNumElements(); i++) {
+                print(elty);
+                m_output << " ";
+                if(elty->isIntType()) m_output << dataArray->getElementAsInt(i);
+                else {
+                    char buffer[32];
+                    auto result = std::to_chars(buffer, buffer + sizeof(buffer), dataArray->getElementAsFloat(i));
+                    m_output << std::string_view(buffer, result.ptr - buffer);
+                }
+                if(i != dataArray->getNumElements() - 1) m_output << ", ";
+            }
+            m_output << " }";
+            break;
+        }
+        case Value::ValueKind::ConstantAggregateZero:
+            print(value->getType());
+            m_output << " zeroinitializer";
+            break;
         case Value::ValueKind::Block:
             m_output << value->getName();
             break;
@@ -0,0 +1,208 @@
+#include "IR/structural_hash.hpp"
+#include "IR/block.hpp"
+#include "IR/function.hpp"
+#include "IR/global_value.hpp"
+#include "IR/instruction.hpp"
+#include "IR/value.hpp"
+#include "cast.hpp"
+#include "type.hpp"
+
+#include <cstring>
+
+namespace scbe::IR {
+
+uint64_t StructuralHash::hash(Function* function) {
+    if(m_cache.contains(function)) return m_cache.at(function);
+    m_inProgress.insert(function);
+    bool outerCycle = m_cycle;
+    m_cycle = false;
+
+    State state;
+    state.m_function = function;
+
+    // number everything up front, phis and jumps can reference values and blocks that come later
+    for(auto& arg : function->getArguments())
+        state.m_numbering[arg.get()] = state.m_numbering.size();
+    for(auto& block : function->getBlocks()) {
+        state.m_numbering[block.get()] = state.m_numbering.size();
+        for(auto& instruction : block->getInstructions())
+            state.m_numbering[instruction.get()] = state.m_numbering.size();
+    }
+
+    add(state, function->getName());
+    addType(state, function->getFunctionType());
+    add(state, (uint64_t)function->getCallingConvention());
+    add(state, function->isIntrinsic());
+
+    for(auto& arg : function->getArguments()) {
+        addType(state, arg->getType());
+        add(state, arg->getFlags());
+    }
+
+    for(auto& block : function->getBlocks()) {
+        add(state, block->getInstructions().size());
+        for(auto& instruction : block->getInstructions()) {
+            add(state, (uint64_t)instruction->getOpcode());
+            addType(state, instruction->getType());
+            add(state, instruction->getFlags());
+            if(instruction->getOpcode() == Instruction::Opcode::Call)
+                add(state, (uint64_t)cast<CallInstruction>(instruction.get())->getCallingConvention());
+
+            add(state, instruction->getOperands().size());
+            for(auto operand : instruction->getOperands())
+                addValue(state, operand);
+        }
+    }
+
+    m_inProgress.erase(function);
+    // a hash that skipped the body of a caller is only complete for the function that started the walk
+    if(!m_cycle || m_inProgress.empty()) m_cache[function] = state.m_hash;
+    m_cycle |= outerCycle;
+    return state.m_hash;
+}
+
+void StructuralHash::add(State& state, uint64_t value) {
+    for(size_t i = 0; i < sizeof(uint64_t); i++) {
+        state.m_hash ^= (value >> (i * 8)) & 0xFF;
+        state.m_hash *= 0x100000001b3ULL;
+    }
+}
+
+void StructuralHash::add(State& state, std::string_view value) {
+    add(state, value.size());
+    for(char c : value) {
+        state.m_hash ^= (uint8_t)c;
+        state.m_hash *= 0x100000001b3ULL;
+    }
+}
+
+void StructuralHash::addType(State& state, Type* type) {
+    if(!type) {
+        add(state, UINT64_MAX);
+        return;
+    }
+
+    add(state, (uint64_t)type->getKind());
+    switch(type->getKind()) {
+        case Type::TypeKind::Integer:
+            add(state, cast<IntegerType>(type)->getBits());
+            return;
+        case Type::TypeKind::Float:
+            add(state, cast<FloatType>(type)->getBits());
+            return;
+        case Type::TypeKind::Struct:
+            add(state, cast<StructType>(type)->getName());
+            break;
+        case Type::TypeKind::Array:
+            add(state, cast<ArrayType>(type)->getScale());
+            break;
+        case Type::TypeKind::Function:
+            add(state, cast<FunctionType>(type)->isVarArg());
+            break;
+        default:
+            break;
+    }
+
+    // recursive structs are only reachable through pointers, stop at the second visit
+    if(m_typeStack.contains(type)) return;
+    m_typeStack.insert(type);
+    add(state, type->getContainedTypes().size());
+    for(auto contained : type->getContainedTypes())
+        addType(state, contained);
+    m_typeStack.erase(type);
+}
+
+void StructuralHash::addValue(State& state, Value* value) {
+    if(!value) {
+        add(state, UINT64_MAX);
+        return;
+    }
+
+    if(state.m_numbering.contains(value)) {
+        add(state, (uint64_t)value->getKind());
+        add(state, state.m_numbering.at(value));
+        return;
+    }
+
+    if(value->getKind() == Value::ValueKind::Register || value->getKind() == Value::ValueKind::FunctionArgument)
+        throw std::runtime_error("Value " + value->getName() + " does not belong to function " + state.m_function->getName());
+
+    addConstant(state, cast<Constant>(value));
+}
+
+void StructuralHash::addConstant(State& state, Constant* constant) {
+    add(state, (uint64_t)constant->getKind());
+    addType(state, constant->getType());
+
+    switch(constant->getKind()) {
+        case Value::ValueKind::ConstantInt:
+            add(state, cast<ConstantInt>(constant)->getValue());
+            break;
+        case Value::ValueKind::ConstantFloat: {
+            double value = cast<ConstantFloat>(constant)->getValue();
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            add(state, bits);
+            break;
+        }
+        case Value::ValueKind::ConstantStruct:
+        case Value::ValueKind::ConstantArray:
+        case Value::ValueKind::ConstantPointer: {
+            ConstantMultiple* multiple = cast<ConstantMultiple>(constant);
+            add(state, multiple->getValues().size());
+            for(auto element : multiple->getValues())
+                addConstant(state, element);
+            break;
+        }
+        case Value::ValueKind::ConstantDataArray: {
+            const std::vector<uint8_t>& data = cast<ConstantDataArray>(constant)->getData();
+            add(state, std::string_view((const char*)data.data(), data.size()));
+            break;
+        }
+        case Value::ValueKind::ConstantAggregateZero:
+            break;
+        case Value::ValueKind::ConstantGEP: {
+            ConstantGEP* gep = cast<ConstantGEP>(constant);
+            addConstant(state, gep->getBase());
+            add(state, gep->getIndices().size());
+            for(auto index : gep->getIndices())
+                addConstant(state, index);
+            break;
+        }
+        case Value::ValueKind::GlobalVariable: {
+            GlobalVariable* global = cast<GlobalVariable>(constant);
+            add(state, global->getName());
+            add(state, (uint64_t)global->getLinkage());
+            // loads from read only globals get folded
+            add(state, global->isReadOnly());
+            if(m_globalStack.contains(global)) break;
+            m_globalStack.insert(global);
+            add(state, global->getValue() != nullptr);
+            if(global->getValue()) addConstant(state, global->getValue());
+            m_globalStack.erase(global);
+            break;
+        }
+        case Value::ValueKind::Function: {
+            Function* function = cast<Function>(constant);
+            add(state, function->getName());
+            add(state, (uint64_t)function->getCallingConvention());
+            if(function == state.m_function) break;
+            if(m_inProgress.contains(function)) {
+                m_cycle = true;
+                break;
+            }
+            add(state, function->hasBody());
+            if(m_includeCalleeBodies && function->hasBody())
+                add(state, hash(function));
+            break;
+        }
+        case Value::ValueKind::Block:
+            // blocks of other functions can't be referenced, only the name is meaningful
+            add(state, constant->getName());
+            break;
+        default:
+            break;
+    }
+}
+
+}
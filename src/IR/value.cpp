@@ -3,30 +3,20 @@
 #include "type_alias.hpp"
 #include "IR/value.hpp"
 
+#include <cassert>
 #include <cstdint>
+#include <cstring>
 
 namespace scbe::IR {
 
-Constant* Constant::getZeroInitalizer(Type* type, DataLayout* layout, Ref<Context> ctx) {
+Constant* Constant::getZeroInitalizer(Type* type, DataLayout*, Ref<Context> ctx) {
     switch(type->getKind()) {
         case Type::TypeKind::Integer: return ctx->getConstantInt(cast<IntegerType>(type)->getBits(), 0);
         case Type::TypeKind::Float: return ctx->getConstantFloat(cast<FloatType>(type)->getBits(), 0);
         case Type::TypeKind::Pointer: return ctx->getNullValue(type);
-        case Type::TypeKind::Struct: {
-            std::vector<IR::Constant*> values;
-            StructType* structType = cast<StructType>(type);
-            for(Type* contained : structType->getContainedTypes())
-                values.push_back(getZeroInitalizer(contained, layout, ctx));
-            return ctx->getConstantStruct(structType, values);
-        }
-        case Type::TypeKind::Array: {
-            std::vector<IR::Constant*> values;
-            ArrayType* arrayType = cast<ArrayType>(type);
-            Constant* zero = getZeroInitalizer(arrayType->getElement(), layout, ctx);
-            for(size_t i = 0; i < arrayType->getScale(); i++)
-                values.push_back(zero);
-            return ctx->getConstantArray(arrayType, values);
-        }
+        case Type::TypeKind::Struct:
+        case Type::TypeKind::Array:
+            return ctx->getConstantAggregateZero(type);
         case Type::TypeKind::Function:
         case Type::TypeKind::Void:
             break;
@@ -50,13 +40,86 @@ ConstantArray* ConstantArray::get(ArrayType* type, const std::vector<Constant*>&
     return context->getConstantArray(type, values);
 }
 
-ConstantArray* ConstantArray::fromString(const std::string& str, Ref<Context> context) {
+ConstantDataArray* ConstantDataArray::get(ArrayType* type, std::vector<uint8_t> data, Ref<Context> context) {
+    return context->getConstantDataArray(type, std::move(data));
+}
+
+ConstantDataArray* ConstantDataArray::get(ArrayType* type, const std::vector<Constant*>& values, Ref<Context> context) {
+    std::vector<uint8_t> data;
+    for(Constant* value : values) {
+        assert(value->getType() == type->getElement() && "Value type mismatch");
+        if(auto constantInt = dyn_cast<ConstantInt>(value)) {
+            int64_t integer = constantInt->getValue();
+            data.insert(data.end(), (uint8_t*)&integer, (uint8_t*)&integer + std::max(1, cast<IntegerType>(value->getType())->getBits() / 8));
+        }
+        else if(cast<FloatType>(value->getType())->getBits() == 32) {
+            float number = cast<ConstantFloat>(value)->getValue();
+            data.insert(data.end(), (uint8_t*)&number, (uint8_t*)&number + sizeof(float));
+        }
+        else {
+            double number = cast<ConstantFloat>(value)->getValue();
+            data.insert(data.end(), (uint8_t*)&number, (uint8_t*)&number + sizeof(double));
+        }
+    }
+    return context->getConstantDataArray(type, std::move(data));
+}
+
+ConstantDataArray* ConstantDataArray::fromString(const std::string& str, Ref<Context> context) {
     ArrayType* type = context->makeArrayType(context->getI8Type(), str.size() + 1);
-    std::vector<Constant*> chars;
-    chars.reserve(str.size());
-    for(auto& c : str) chars.push_back(context->getConstantInt(8, c));
-    chars.push_back(context->getConstantInt(8, '\0'));
-    return context->getConstantArray(type, chars);
+    std::vector<uint8_t> data(str.begin(), str.end());
+    data.push_back('\0');
+    return context->getConstantDataArray(type, std::move(data));
+}
+
+size_t ConstantDataArray::getElementSize() const {
+    Type* element = getElementType();
+    if(element->isFltType()) return cast<FloatType>(element)->getBits() / 8;
+    return std::max(1, cast<IntegerType>(element)->getBits() / 8);
+}
+
+int64_t ConstantDataArray::getElementAsInt(size_t index) const {
+    assert(getElementType()->isIntType() && "Not an integer array");
+    size_t size = getElementSize();
+    uint64_t value = 0;
+    std::memcpy(&value, m_data.data() + index * size, size);
+    // sign extend like ConstantInt does for narrower types
+    if(size < 8) value = (int64_t)(value << (64 - size * 8)) >> (64 - size * 8);
+    return value;
+}
+
+double ConstantDataArray::getElementAsFloat(size_t index) const {
+    assert(getElementType()->isFltType() && "Not a float array");
+    if(getElementSize() == 4) {
+        float value;
+        std::memcpy(&value, m_data.data() + index * 4, 4);
+        return value;
+    }
+    double value;
+    std::memcpy(&value, m_data.data() + index * 8, 8);
+    return value;
+}
+
+Constant* ConstantDataArray::getElementAsConstant(size_t index, Ref<Context> context) const {
+    if(getElementType()->isFltType()) return context->getConstantFloat(getElementSize() * 8, getElementAsFloat(index));
+    return context->getConstantInt(cast<IntegerType>(getElementType())->getBits(), getElementAsInt(index));
+}
+
+bool ConstantDataArray::isString() const {
+    if(!getElementType()->isIntType() || cast<IntegerType>(getElementType())->getBits() != 8 || m_data.empty()) return false;
+    return m_data.back() == 0 && std::find(m_data.begin(), m_data.end() - 1, 0) == m_data.end() - 1;
+}
+
+std::string ConstantDataArray::getAsString() const {
+    return std::string(m_data.begin(), m_data.end());
+}
+
+ConstantAggregateZero* ConstantAggregateZero::get(Type* type, Ref<Context> context) {
+    return context->getConstantAggregateZero(type);
+}
+
+Constant* ConstantAggregateZero::getElement(size_t index, DataLayout* layout, Ref<Context> context) const {
+    Type* element = m_type->isStructType() ? m_type->getContainedTypes().at(index) : m_type->getContainedTypes().at(0);
+    return getZeroInitalizer(element, layout, context);
 }
 
 UndefValue* UndefValue::get(Type* type, Ref<Context> context) {
@@ -120,6 +183,27 @@ ConstantPointer* tryEvaluateInternal(IR::ConstantGEP* gep, Ref<Context> ctx) {
                 current = multi->getValues().at(idx->getValue());
                 break;
             }
+            case IR::Value::ValueKind::ConstantDataArray: {
+                IR::ConstantDataArray* data = cast<ConstantDataArray>(current);
+                if(idx->getValue() < 0 || (size_t)idx->getValue() >= data->getNumElements()) return nullptr;
+                if(i == gep->getIndices().size() - 1) {
+                    for(size_t j = idx->getValue(); j < data->getNumElements(); j++)
+                        pointees.push_back(data->getElementAsConstant(j, ctx));
+                    break;
+                }
+                current = data->getElementAsConstant(idx->getValue(), ctx);
+                break;
+            }
+            case IR::Value::ValueKind::ConstantAggregateZero: {
+                IR::ConstantAggregateZero* zero = cast<ConstantAggregateZero>(current);
+                Constant* element = zero->getElement(idx->getValue(), nullptr, ctx);
+                if(i == gep->getIndices().size() - 1) {
+                    pointees.push_back(element);
+                    break;
+                }
+                current = element;
+                break;
+            }
             case IR::Value::ValueKind::GlobalVariable: {
                 if(idx->getValue() != 0) return nullptr;
                 IR::GlobalVariable* ptr = cast<GlobalVariable>(current);
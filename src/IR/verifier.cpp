@@ -1,7 +1,9 @@
 #include "IR/verifier.hpp"
 #include "IR/function.hpp"
 #include "IR/block.hpp"
+#include "IR/global_value.hpp"
 #include "IR/instruction.hpp"
+#include "unit.hpp"
 #include "type.hpp"
 #include <algorithm>
 
@@ -18,6 +20,37 @@ bool Verifier::run(Function* function) {
     return false;
 }
 
+void Verifier::init(Unit& unit) {
+    for(auto& global : unit.getGlobals()) {
+        if(!global->getValue()) continue;
+        verify(global->getValue(), global.get());
+    }
+}
+
+void Verifier::verify(Constant* constant, GlobalVariable* global) {
+    switch(constant->getKind()) {
+        case Value::ValueKind::ConstantStruct:
+        case Value::ValueKind::ConstantArray:
+            for(auto value : cast<ConstantMultiple>(constant)->getValues())
+                verify(value, global);
+            break;
+        case Value::ValueKind::ConstantDataArray: {
+            ConstantDataArray* data = cast<ConstantDataArray>(constant);
+            if(!data->getElementType()->isIntType() && !data->getElementType()->isFltType())
+                m_diagnosticEmitter->error("Global " + global->getName() + " has a data array of non numeric elements", std::nullopt);
+            else if(data->getData().size() != data->getNumElements() * data->getElementSize())
+                m_diagnosticEmitter->error("Global " + global->getName() + " has a data array of " + std::to_string(data->getData().size()) + " bytes, expected " + std::to_string(data->getNumElements() * data->getElementSize()), std::nullopt);
+            break;
+        }
+        case Value::ValueKind::ConstantAggregateZero:
+            if(!constant->getType()->isStructType() && !constant->getType()->isArrayType())
+                m_diagnosticEmitter->error("Global " + global->getName() + " has a zeroinitializer of non aggregate type", std::nullopt);
+            break;
+        default:
+            break;
+    }
+}
+
 void Verifier::verify(Block* block) {
     if(block->getInstructions().empty())
         m_diagnosticEmitter->error("Block " + block->getName() + " has no instructions", block->getSourceLocation());
@@ -1,12 +1,13 @@
 #include "codegen/coff_object_emitter.hpp"
 #include "IR/function.hpp"
-#include "IR/block.hpp"
 #include "codegen/fixup.hpp"
 #include "coffi/coffi_types.hpp"
 #include "unit.hpp"
 
 #include <coffi/coffi.hpp>
 
+#include <algorithm>
+
 using namespace COFFI;
 
 #define ADDR64 1
@@ -27,25 +28,56 @@ void COFFObjectEmitter::emitObjectFile(Unit& unit) {
 
     section* dataSec = writer.add_section(".data");
     dataSec->set_flags(IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE | IMAGE_SCN_ALIGN_4BYTES);
-    dataSec->set_data((const char*)m_dataBytes.data(), m_dataBytes.size());
 
     section* bssSec = writer.add_section(".bss");
     bssSec->set_flags(IMAGE_SCN_MEM_READ | IMAGE_SCN_MEM_WRITE |
                        IMAGE_SCN_CNT_UNINITIALIZED_DATA |
                        IMAGE_SCN_ALIGN_4BYTES);
 
+    section* rdataSec = writer.add_section(".rdata");
+    rdataSec->set_flags(IMAGE_SCN_CNT_INITIALIZED_DATA | IMAGE_SCN_MEM_READ | IMAGE_SCN_ALIGN_4BYTES);
+
+    // pe has no relro or mergeable strings, everything read only goes to .rdata
+    std::vector<std::pair<std::string, DataEntry>> dataEntries(m_dataLocTable.begin(), m_dataLocTable.end());
+    std::sort(dataEntries.begin(), dataEntries.end(), [](auto& a, auto& b) {
+        return a.second.m_loc != b.second.m_loc ? a.second.m_loc < b.second.m_loc : a.second.m_size < b.second.m_size;
+    });
+    std::vector<uint8_t> dataBytes, rdataBytes;
+    size_t bssSize = 0;
+    std::vector<std::pair<section*, size_t>> placements;
+    for(auto& [name, entry] : dataEntries) {
+        auto begin = m_dataBytes.begin() + entry.m_loc;
+        switch(entry.m_section) {
+            case DataSection::Data:
+                placements.push_back({dataSec, dataBytes.size()});
+                dataBytes.insert(dataBytes.end(), begin, begin + entry.m_size);
+                break;
+            case DataSection::ReadOnly:
+            case DataSection::RelocatedReadOnly:
+            case DataSection::Strings:
+                placements.push_back({rdataSec, rdataBytes.size()});
+                rdataBytes.insert(rdataBytes.end(), begin, begin + entry.m_size);
+                break;
+            case DataSection::Zero:
+                placements.push_back({bssSec, bssSize});
+                bssSize += entry.m_size;
+                break;
+        }
+    }
+
     section* vSec = writer.add_section(".rdata$zzz");
     vSec->set_flags(IMAGE_SCN_MEM_READ | IMAGE_SCN_CNT_INITIALIZED_DATA |
                      IMAGE_SCN_ALIGN_4BYTES);
 
     UMap<std::string, symbol*> symbols;
 
-    for(const auto& [name, dataEntry] : m_dataLocTable) {
+    for(size_t i = 0; i < dataEntries.size(); i++) {
+        const auto& [name, dataEntry] = dataEntries.at(i);
         symbol* sym = writer.add_symbol(name);
-        sym->set_section_number(dataSec->get_index() + 1);
-        sym->set_value(dataEntry.m_loc);
+        sym->set_section_number(placements.at(i).first->get_index() + 1);
+        sym->set_value(placements.at(i).second);
         sym->set_type(IMAGE_SYM_TYPE_NULL); // maybe TODO map type to this
-        sym->set_storage_class(dataEntry.m_globalAddress->getValue()->getLinkage() == IR::Linkage::External ? IMAGE_SYM_CLASS_EXTERNAL : IMAGE_SYM_CLASS_STATIC);
+        sym->set_storage_class(dataEntry.m_linkage == IR::Linkage::External ? IMAGE_SYM_CLASS_EXTERNAL : IMAGE_SYM_CLASS_STATIC);
         auxiliary_symbol_record a{};
         sym->get_auxiliary_symbols().push_back(a);
         symbols.insert({name, sym});
@@ -75,22 +107,9 @@ void COFFObjectEmitter::emitObjectFile(Unit& unit) {
         {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
         sym->get_auxiliary_symbols().push_back(a2);
         symbols.insert({function->getName(), sym});
-
-        for(auto& block : function->getBlocks()) {
-            symbol* sym = writer.add_symbol(block->getName());
-            sym->set_section_number(textSec->get_index() + 1);
-            sym->set_value(m_codeLocTable.at(block->getName()));
-            sym->set_type(IMAGE_SYM_TYPE_NOT_FUNCTION);
-            sym->set_storage_class(IMAGE_SYM_CLASS_EXTERNAL);
-            sym->set_aux_symbols_number(1);
-            auxiliary_symbol_record a2{
-            {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
-            sym->get_auxiliary_symbols().push_back(a2);
-            symbols.insert({block->getName(), sym});
-        }
     }
 
-    uint16_t textRelocations = 0, dataRelocations = 0;
+    uint16_t textRelocations = 0, dataRelocations = 0, rdataRelocations = 0;
 
     for(auto& fixup : m_fixups) {
         if(fixup.getSection() == Fixup::Data || (fixup.getSection() == Fixup::Text && !m_codeLocTable.contains(fixup.getSymbol()))) {
@@ -113,14 +132,20 @@ void COFFObjectEmitter::emitObjectFile(Unit& unit) {
                 textRelocations++;
             }
             else if(fixup.getSection() == Fixup::Data) {
-                int32_t rel = fixup.getAddend();
-                for (size_t i = 0; i < 4; i++) {
-                    m_codeBytes[fixup.getLocation() + i] = rel & 0xFF;
+                auto it = std::upper_bound(dataEntries.begin(), dataEntries.end(), fixup.getLocation(), [](size_t location, auto& entry) { return location < entry.second.m_loc; });
+                const auto& [sec, offset] = placements.at(std::distance(dataEntries.begin(), it) - 1);
+                size_t location = offset + fixup.getLocation() - (it - 1)->second.m_loc;
+                std::vector<uint8_t>& bytes = sec == dataSec ? dataBytes : rdataBytes;
+                int64_t rel = fixup.getAddend();
+                for (size_t i = 0; i < 8; i++) {
+                    bytes[location + i] = rel & 0xFF;
                     rel >>= 8;
                 }
+                rela.virtual_address = location;
                 rela.type = ADDR64;
-                dataSec->add_relocation_entry(&rela);
-                dataRelocations++;
+                sec->add_relocation_entry(&rela);
+                if(sec == dataSec) dataRelocations++;
+                else rdataRelocations++;
             }
             continue;
         }
@@ -134,6 +159,9 @@ void COFFObjectEmitter::emitObjectFile(Unit& unit) {
     }
 
     textSec->set_data((const char*)m_codeBytes.data(), m_codeBytes.size());
+    if(!dataBytes.empty()) dataSec->set_data((const char*)dataBytes.data(), dataBytes.size());
+    if(!rdataBytes.empty()) rdataSec->set_data((const char*)rdataBytes.data(), rdataBytes.size());
+    bssSec->set_data_size(bssSize);
 
     writer.add_symbol(".file");
 
@@ -167,6 +195,16 @@ void COFFObjectEmitter::emitObjectFile(Unit& unit) {
     bssSym->get_auxiliary_symbols().push_back(
         *reinterpret_cast<auxiliary_symbol_record*>(&a5));
 
+    symbol* readOnlySym = writer.add_symbol(".rdata");
+    readOnlySym->set_type(IMAGE_SYM_TYPE_NOT_FUNCTION);
+    readOnlySym->set_storage_class(IMAGE_SYM_CLASS_STATIC);
+    readOnlySym->set_section_number(rdataSec->get_index() + 1);
+    readOnlySym->set_aux_symbols_number(1);
+    auxiliary_symbol_record_5 a7{
+        rdataSec->get_data_size(), rdataRelocations, 0, 0, 0, 0, {0, 0, 0}};
+    readOnlySym->get_auxiliary_symbols().push_back(
+        *reinterpret_cast<auxiliary_symbol_record*>(&a7));
+
     symbol* rdataSym = writer.add_symbol(".rdata$zzz");
     rdataSym->set_type(IMAGE_SYM_TYPE_NOT_FUNCTION);
     rdataSym->set_storage_class(IMAGE_SYM_CLASS_STATIC);
@@ -0,0 +1,182 @@
+#include "codegen/compilation_cache.hpp"
+#include "IR/function.hpp"
+#include "IR/global_value.hpp"
+#include "hash.hpp"
+#include "unit.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace scbe::Codegen {
+
+static constexpr uint32_t s_cacheMagic = 0x43424353; // SCBC
+static constexpr uint32_t s_cacheVersion = 2;
+
+namespace {
+
+void writeInt(std::ostream& os, uint64_t value) {
+    os.write((const char*)&value, sizeof(value));
+}
+
+void writeString(std::ostream& os, const std::string& value) {
+    writeInt(os, value.size());
+    os.write(value.data(), value.size());
+}
+
+void writeBytes(std::ostream& os, const std::vector<uint8_t>& bytes) {
+    writeInt(os, bytes.size());
+    os.write((const char*)bytes.data(), bytes.size());
+}
+
+void writeFixups(std::ostream& os, const std::vector<Fixup>& fixups) {
+    writeInt(os, fixups.size());
+    for(auto& fixup : fixups) {
+        writeString(os, fixup.getSymbol());
+        writeInt(os, fixup.getLocation());
+        writeInt(os, fixup.getInstructionSize());
+        writeInt(os, fixup.getSection());
+        writeInt(os, fixup.isFunction());
+        writeInt(os, fixup.getAddend());
+    }
+}
+
+uint64_t readInt(std::istream& is) {
+    uint64_t value = 0;
+    if(!is.read((char*)&value, sizeof(value))) throw std::runtime_error("Truncated cache entry");
+    return value;
+}
+
+std::string readString(std::istream& is) {
+    std::string value(readInt(is), '\0');
+    if(!is.read(value.data(), value.size())) throw std::runtime_error("Truncated cache entry");
+    return value;
+}
+
+std::vector<uint8_t> readBytes(std::istream& is) {
+    std::vector<uint8_t> bytes(readInt(is));
+    if(!is.read((char*)bytes.data(), bytes.size())) throw std::runtime_error("Truncated cache entry");
+    return bytes;
+}
+
+std::vector<Fixup> readFixups(std::istream& is) {
+    std::vector<Fixup> fixups;
+    size_t size = readInt(is);
+    for(size_t i = 0; i < size; i++) {
+        std::string symbol = readString(is);
+        size_t location = readInt(is);
+        size_t instructionSize = readInt(is);
+        Fixup::Section section = (Fixup::Section)readInt(is);
+        bool function = readInt(is);
+        int64_t addend = readInt(is);
+        fixups.push_back(Fixup(symbol, location, instructionSize, section, function, addend));
+    }
+    return fixups;
+}
+
+}
+
+const CachedFunction* CompilationCache::find(uint64_t key) {
+    if(!m_entries.contains(key) && !m_directory.empty()) {
+        if(auto entry = load(key))
+            m_entries[key] = std::move(entry.value());
+    }
+
+    if(m_entries.contains(key)) {
+        m_hits++;
+        return &m_entries.at(key);
+    }
+    m_misses++;
+    return nullptr;
+}
+
+void CompilationCache::insert(uint64_t key, CachedFunction entry) {
+    if(!m_directory.empty()) save(key, entry);
+    m_entries[key] = std::move(entry);
+}
+
+std::optional<uint64_t> CompilationCache::getKey(IR::Function* function) const {
+    if(!m_keys.contains(function)) return std::nullopt;
+    return m_keys.at(function);
+}
+
+std::string CompilationCache::getPrivateDataName(const std::string& function, size_t index) {
+    return function + ".cache" + std::to_string(index);
+}
+
+std::string CompilationCache::getPath(uint64_t key) const {
+    std::stringstream ss;
+    ss << std::hex << key;
+    return (std::filesystem::path(m_directory) / (ss.str() + ".scbecache")).string();
+}
+
+std::optional<CachedFunction> CompilationCache::load(uint64_t key) const {
+    std::ifstream is(getPath(key), std::ios::binary);
+    if(!is) return std::nullopt;
+
+    // a stale or broken entry is just a miss, it will be overwritten
+    try {
+        if(readInt(is) != (((uint64_t)s_cacheVersion << 32) | s_cacheMagic)) return std::nullopt;
+        CachedFunction entry;
+        entry.m_code = readBytes(is);
+        entry.m_fixups = readFixups(is);
+        size_t dataSize = readInt(is);
+        for(size_t i = 0; i < dataSize; i++) {
+            CachedData data;
+            data.m_bytes = readBytes(is);
+            data.m_fixups = readFixups(is);
+            data.m_readOnly = readInt(is);
+            entry.m_data.push_back(std::move(data));
+        }
+        return entry;
+    }
+    catch(const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+void CompilationCache::save(uint64_t key, const CachedFunction& entry) const {
+    std::filesystem::create_directories(m_directory);
+    std::string path = getPath(key);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream os(tmpPath, std::ios::binary | std::ios::trunc);
+        if(!os) throw std::runtime_error("Could not write cache entry " + tmpPath);
+        writeInt(os, ((uint64_t)s_cacheVersion << 32) | s_cacheMagic);
+        writeBytes(os, entry.m_code);
+        writeFixups(os, entry.m_fixups);
+        writeInt(os, entry.m_data.size());
+        for(auto& data : entry.m_data) {
+            writeBytes(os, data.m_bytes);
+            writeFixups(os, data.m_fixups);
+            writeInt(os, data.m_readOnly);
+        }
+    }
+    // concurrent compilations may race on the same key, the rename keeps readers from seeing half written entries
+    std::filesystem::rename(tmpPath, path);
+}
+
+void CompilationCacheLookup::init(Unit& unit) {
+    m_hasher = IR::StructuralHash(m_level >= OptimizationLevel::O1);
+    m_cache->m_keys.clear();
+    m_cache->m_sourceGlobals.clear();
+    for(auto& global : unit.getGlobals())
+        m_cache->m_sourceGlobals.insert(global->getName());
+    for(auto& function : unit.getFunctions())
+        function->setPrecompiled(false);
+}
+
+bool CompilationCacheLookup::run(IR::Function* function) {
+    size_t key = m_hasher.hash(function);
+    hashCombine(key, (size_t)m_spec.getArch());
+    hashCombine(key, (size_t)m_spec.getVendor());
+    hashCombine(key, (size_t)m_spec.getOS());
+    hashCombine(key, (size_t)m_spec.getABI());
+    hashCombine(key, (size_t)m_level);
+
+    m_cache->m_keys[function] = key;
+    if(m_cache->find(key)) function->setPrecompiled(true);
+    return false;
+}
+
+}
@@ -1,16 +1,56 @@
 #include "codegen/elf_object_emitter.hpp"
 #include "IR/function.hpp"
-#include "IR/block.hpp"
 #include "codegen/fixup.hpp"
 #include "elfio/elf_types.hpp"
 #include "unit.hpp"
 
 #include <elfio/elfio.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
 using namespace ELFIO;
 
 namespace scbe::Codegen {
 
+namespace {
+
+// Becomes one ELF section, code is a range of m_codeBytes while data entries are copied in
+struct Chunk {
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    std::vector<uint8_t> m_bytes;
+    section* m_section = nullptr;
+    section* m_group = nullptr;
+    section* m_relaSection = nullptr;
+    std::unique_ptr<relocation_section_accessor> m_rela;
+};
+
+struct DataPlacement {
+    size_t m_chunk;
+    size_t m_offset;
+};
+
+std::string getSectionName(DataSection section) {
+    switch(section) {
+        case DataSection::Data: return ".data";
+        case DataSection::ReadOnly: return ".rodata";
+        case DataSection::RelocatedReadOnly: return ".data.rel.ro";
+        case DataSection::Strings: return ".rodata.str1.1";
+        case DataSection::Zero: return ".bss";
+    }
+    return ".data";
+}
+
+size_t findChunk(const std::vector<Chunk>& chunks, size_t location) {
+    auto it = std::upper_bound(chunks.begin(), chunks.end(), location, [](size_t location, const Chunk& chunk) { return location < chunk.m_begin; });
+    assert(it != chunks.begin());
+    return std::distance(chunks.begin(), it) - 1;
+}
+
+}
+
 void ELFObjectEmitter::emitObjectFile(Unit& unit) {
     elfio writer;
     writer.create(ELFCLASS64, ELFDATA2LSB);
@@ -18,16 +58,98 @@ void ELFObjectEmitter::emitObjectFile(Unit& unit) {
     writer.set_machine(EM_X86_64); // TODO map machine
     writer.set_os_abi(ELFOSABI_LINUX); // TODO map os to this
 
-    section* textSection = writer.sections.add(".text");
-    textSection->set_type( SHT_PROGBITS );
-    textSection->set_flags( SHF_ALLOC | SHF_EXECINSTR );
-    textSection->set_addr_align( 0x10 );
+    bool functionSections = m_options.m_functionSections || m_options.m_comdat;
+
+    // functions are laid out back to back, so each one ends where the next begins
+    std::vector<IR::Function*> functions;
+    for(auto& function : unit.getFunctions())
+        if(function->hasBody()) functions.push_back(function.get());
+    std::sort(functions.begin(), functions.end(), [&](IR::Function* a, IR::Function* b) {
+        return m_codeLocTable.at(a->getName()) < m_codeLocTable.at(b->getName());
+    });
+
+    std::vector<Chunk> textChunks;
+    std::vector<std::pair<section*, Elf_Word>> groups;
+    UMap<std::string, size_t> functionChunks;
+    if(functionSections) {
+        for(size_t i = 0; i < functions.size(); i++) {
+            IR::Function* function = functions.at(i);
+            Chunk chunk;
+            chunk.m_begin = m_codeLocTable.at(function->getName());
+            chunk.m_end = i + 1 < functions.size() ? m_codeLocTable.at(functions.at(i + 1)->getName()) : m_codeBytes.size();
+            // the group section has to come before its members
+            if(m_options.m_comdat && function->getLinkage() == IR::Linkage::External) {
+                chunk.m_group = writer.sections.add(".group");
+                chunk.m_group->set_type(SHT_GROUP);
+                chunk.m_group->set_addr_align(4);
+                chunk.m_group->set_entry_size(4);
+            }
+            chunk.m_section = writer.sections.add(".text." + function->getName());
+            functionChunks[function->getName()] = textChunks.size();
+            textChunks.push_back(std::move(chunk));
+        }
+    }
+    if(textChunks.empty()) {
+        Chunk chunk;
+        chunk.m_begin = 0;
+        chunk.m_end = m_codeBytes.size();
+        chunk.m_section = writer.sections.add(".text");
+        textChunks.push_back(std::move(chunk));
+    }
+    for(auto& chunk : textChunks) {
+        chunk.m_section->set_type(SHT_PROGBITS);
+        chunk.m_section->set_flags(SHF_ALLOC | SHF_EXECINSTR | (chunk.m_group ? SHF_GROUP : 0));
+        chunk.m_section->set_addr_align(0x10);
+    }
+
+    std::vector<std::pair<std::string, DataEntry>> dataEntries(m_dataLocTable.begin(), m_dataLocTable.end());
+    // empty entries go first so a location always maps to the entry that actually holds it
+    std::sort(dataEntries.begin(), dataEntries.end(), [](auto& a, auto& b) {
+        return a.second.m_loc != b.second.m_loc ? a.second.m_loc < b.second.m_loc : a.second.m_size < b.second.m_size;
+    });
 
-    section* data_sec = writer.sections.add(".data");
-    data_sec->set_type(SHT_PROGBITS);
-    data_sec->set_flags(SHF_ALLOC);
-    data_sec->set_addr_align(1);
-    data_sec->set_data((const char*)m_dataBytes.data(), m_dataBytes.size());
+    // strings share one section even with data sections, the linker merges them anyway
+    std::vector<Chunk> dataChunks;
+    std::vector<DataPlacement> placements;
+    UMap<std::string, size_t> sharedChunks;
+    for(auto& [name, entry] : dataEntries) {
+        bool own = m_options.m_dataSections && entry.m_section != DataSection::Strings;
+        std::string sectionName = getSectionName(entry.m_section) + (own ? "." + name : "");
+        if(own || !sharedChunks.contains(sectionName)) {
+            Chunk chunk;
+            chunk.m_section = writer.sections.add(sectionName);
+            switch(entry.m_section) {
+                case DataSection::Data:
+                case DataSection::RelocatedReadOnly:
+                    chunk.m_section->set_type(SHT_PROGBITS);
+                    chunk.m_section->set_flags(SHF_ALLOC | SHF_WRITE);
+                    break;
+                case DataSection::ReadOnly:
+                    chunk.m_section->set_type(SHT_PROGBITS);
+                    chunk.m_section->set_flags(SHF_ALLOC);
+                    break;
+                case DataSection::Strings:
+                    chunk.m_section->set_type(SHT_PROGBITS);
+                    chunk.m_section->set_flags(SHF_ALLOC | SHF_MERGE | SHF_STRINGS);
+                    chunk.m_section->set_entry_size(1);
+                    break;
+                case DataSection::Zero:
+                    chunk.m_section->set_type(SHT_NOBITS);
+                    chunk.m_section->set_flags(SHF_ALLOC | SHF_WRITE);
+                    break;
+            }
+            chunk.m_section->set_addr_align(1);
+            if(!own) sharedChunks[sectionName] = dataChunks.size();
+            dataChunks.push_back(std::move(chunk));
+        }
+
+        size_t chunkIndex = own ? dataChunks.size() - 1 : sharedChunks.at(sectionName);
+        Chunk& chunk = dataChunks.at(chunkIndex);
+        placements.push_back({chunkIndex, chunk.m_end});
+        if(entry.m_section != DataSection::Zero)
+            chunk.m_bytes.insert(chunk.m_bytes.end(), m_dataBytes.begin() + entry.m_loc, m_dataBytes.begin() + entry.m_loc + entry.m_size);
+        chunk.m_end += entry.m_size;
+    }
 
     section* str_sec = writer.sections.add( ".strtab" );
     str_sec->set_type( SHT_STRTAB );
@@ -45,13 +167,15 @@ void ELFObjectEmitter::emitObjectFile(Unit& unit) {
     UMap<std::string, Elf32_Word> symbols;
     UMap<std::string, Elf_Word> symbolLocations;
 
-    for(const auto& [name, dataEntry] : m_dataLocTable) {
+    for(size_t i = 0; i < dataEntries.size(); i++) {
+        const auto& [name, dataEntry] = dataEntries.at(i);
+        const DataPlacement& placement = placements.at(i);
         Elf32_Word index = stra.add_string(name);
         symbols.insert({name, index});
         Elf_Word sym = syma.add_symbol(
-        index, dataEntry.m_loc, 0,
-            dataEntry.m_globalAddress->getValue()->getLinkage() == IR::Linkage::External ? STB_GLOBAL : STB_LOCAL,
-            STT_OBJECT, 0, data_sec->get_index() );
+        index, placement.m_offset, dataEntry.m_size,
+            dataEntry.m_linkage == IR::Linkage::External ? STB_GLOBAL : STB_LOCAL,
+            STT_OBJECT, 0, dataChunks.at(placement.m_chunk).m_section->get_index() );
         symbolLocations.insert({name, sym});
     }
 
@@ -62,57 +186,59 @@ void ELFObjectEmitter::emitObjectFile(Unit& unit) {
         symbolLocations.insert({ext.second->getName(), sym});
     }
 
-    for(auto& function : unit.getFunctions()) {
-        if(!function->hasBody()) continue;
+    // which text chunk a code symbol lives in, fixups across chunks need a relocation
+    UMap<std::string, size_t> codeChunkOf;
+    for(size_t i = 0; i < functions.size(); i++) {
+        IR::Function* function = functions.at(i);
+        size_t begin = m_codeLocTable.at(function->getName());
+        size_t end = i + 1 < functions.size() ? m_codeLocTable.at(functions.at(i + 1)->getName()) : m_codeBytes.size();
+        size_t chunkIndex = functionChunks.contains(function->getName()) ? functionChunks.at(function->getName()) : 0;
+        Chunk& chunk = textChunks.at(chunkIndex);
         Elf32_Word index = stra.add_string(function->getName());
         symbols.insert({function->getName(), index});
         Elf_Word sym = syma.add_symbol(
-        index, m_codeLocTable.at(function->getName()), 0,
+        index, begin - chunk.m_begin, end - begin,
             function->getLinkage() == IR::Linkage::External ? STB_GLOBAL : STB_LOCAL,
-            STT_FUNC, 0, textSection->get_index() );
+            STT_FUNC, 0, chunk.m_section->get_index() );
         symbolLocations.insert({function->getName(), sym});
-
-        for(auto& block : function->getBlocks()) {
-            Elf32_Word index = stra.add_string(block->getName());
-            symbols.insert({block->getName(), index});
-            Elf_Word sym = syma.add_symbol(
-            index, m_codeLocTable.at(block->getName()), 0,
-                function->getLinkage() == IR::Linkage::External ? STB_GLOBAL : STB_LOCAL,
-                STT_SECTION, 0, textSection->get_index() );
-            symbolLocations.insert({block->getName(), sym});
-        }
+        codeChunkOf[function->getName()] = chunkIndex;
+        if(chunk.m_group) groups.push_back({chunk.m_group, sym});
     }
-        
-    section* relTextSec = writer.sections.add( ".rela.text" );
-    relTextSec->set_type( SHT_RELA );
-    relTextSec->set_info( textSection->get_index() );
-    relTextSec->set_addr_align( 8 );
-    relTextSec->set_entry_size( writer.get_default_entry_size( SHT_RELA ) );
-    relTextSec->set_link( sym_sec->get_index() );
-    relocation_section_accessor relaText( writer, relTextSec );
-
-    section* relDataSec = writer.sections.add( ".rela.data" );
-    relDataSec->set_type( SHT_RELA );
-    relDataSec->set_info( data_sec->get_index() );
-    relDataSec->set_addr_align( 8 );
-    relDataSec->set_entry_size( writer.get_default_entry_size( SHT_RELA ) );
-    relDataSec->set_link( sym_sec->get_index() );
-    relocation_section_accessor relaData( writer, relDataSec );
+
+    auto getRela = [&](Chunk& chunk) -> relocation_section_accessor& {
+        if(chunk.m_rela) return *chunk.m_rela;
+        chunk.m_relaSection = writer.sections.add(".rela" + chunk.m_section->get_name());
+        chunk.m_relaSection->set_type( SHT_RELA );
+        chunk.m_relaSection->set_info( chunk.m_section->get_index() );
+        chunk.m_relaSection->set_addr_align( 8 );
+        chunk.m_relaSection->set_entry_size( writer.get_default_entry_size( SHT_RELA ) );
+        chunk.m_relaSection->set_link( sym_sec->get_index() );
+        if(chunk.m_group) chunk.m_relaSection->set_flags( SHF_GROUP | SHF_INFO_LINK );
+        chunk.m_rela = std::make_unique<relocation_section_accessor>(writer, chunk.m_relaSection);
+        return *chunk.m_rela;
+    };
 
     for(auto& fixup : m_fixups) {
-        if(fixup.getSection() == Fixup::Data || (fixup.getSection() == Fixup::Text && !m_codeLocTable.contains(fixup.getSymbol()))) {
-            if(!symbolLocations.contains(fixup.getSymbol())) {
-                throw std::runtime_error("Could not find symbol " + fixup.getSymbol());
-            }
-            if(fixup.getSection() == Fixup::Text) {
-                uint32_t type = unit.getExternals().contains(fixup.getSymbol()) && fixup.isFunction() ? R_X86_64_PLT32 : R_X86_64_PC32;
-                relaText.add_entry( fixup.getLocation(), symbolLocations.at(fixup.getSymbol()),
-                        (unsigned char)(type), fixup.getAddend()-4 ); // TODO pick these based on spec
-            }
-            else if(fixup.getSection() == Fixup::Data) {
-                relaData.add_entry( fixup.getLocation(), symbolLocations.at(fixup.getSymbol()),
-                        (unsigned char)(R_X86_64_64), fixup.getAddend() );
-            }
+        if(!symbolLocations.contains(fixup.getSymbol())) {
+            throw std::runtime_error("Could not find symbol " + fixup.getSymbol());
+        }
+        if(fixup.getSection() == Fixup::Data) {
+            auto it = std::upper_bound(dataEntries.begin(), dataEntries.end(), fixup.getLocation(), [](size_t location, auto& entry) { return location < entry.second.m_loc; });
+            assert(it != dataEntries.begin());
+            const auto& [name, entry] = *(it - 1);
+            const DataPlacement& placement = placements.at(std::distance(dataEntries.begin(), it) - 1);
+            getRela(dataChunks.at(placement.m_chunk)).add_entry( placement.m_offset + fixup.getLocation() - entry.m_loc, symbolLocations.at(fixup.getSymbol()),
+                    (unsigned char)(R_X86_64_64), fixup.getAddend() );
+            continue;
+        }
+
+        size_t chunkIndex = findChunk(textChunks, fixup.getLocation());
+        Chunk& chunk = textChunks.at(chunkIndex);
+        if(!codeChunkOf.contains(fixup.getSymbol()) || codeChunkOf.at(fixup.getSymbol()) != chunkIndex) {
+            bool call = fixup.isFunction() && (unit.getExternals().contains(fixup.getSymbol()) || codeChunkOf.contains(fixup.getSymbol()));
+            uint32_t type = call ? R_X86_64_PLT32 : R_X86_64_PC32;
+            getRela(chunk).add_entry( fixup.getLocation() - chunk.m_begin, symbolLocations.at(fixup.getSymbol()),
+                    (unsigned char)(type), fixup.getAddend()-4 ); // TODO pick these based on spec
             continue;
         }
         size_t loc = m_codeLocTable.at(fixup.getSymbol());
@@ -124,8 +250,20 @@ void ELFObjectEmitter::emitObjectFile(Unit& unit) {
         }
     }
 
-    textSection->set_data( (const char*)m_codeBytes.data(), m_codeBytes.size() );
+    for(auto& chunk : textChunks)
+        chunk.m_section->set_data( (const char*)m_codeBytes.data() + chunk.m_begin, chunk.m_end - chunk.m_begin );
+    for(auto& chunk : dataChunks) {
+        if(chunk.m_section->get_type() == SHT_NOBITS) chunk.m_section->set_size(chunk.m_end);
+        else chunk.m_section->set_data( (const char*)chunk.m_bytes.data(), chunk.m_bytes.size() );
+    }
 
+    for(auto& chunk : textChunks) {
+        if(!chunk.m_group) continue;
+        std::vector<Elf_Word> members = { GRP_COMDAT, chunk.m_section->get_index() };
+        if(chunk.m_relaSection) members.push_back(chunk.m_relaSection->get_index());
+        chunk.m_group->set_link( sym_sec->get_index() );
+        chunk.m_group->set_data( (const char*)members.data(), members.size() * sizeof(Elf_Word) );
+    }
     // section* note_sec = writer.sections.add( ".note" );
     // note_sec->set_type( SHT_NOTE );
 
@@ -141,9 +279,17 @@ void ELFObjectEmitter::emitObjectFile(Unit& unit) {
     gs->set_addr_align(1);
 
     syma.arrange_local_symbols( [&]( Elf_Xword first, Elf_Xword second ) {
-        relaData.swap_symbols( first, second );
-        relaText.swap_symbols( first, second );
+        for(auto& chunk : textChunks)
+            if(chunk.m_rela) chunk.m_rela->swap_symbols( first, second );
+        for(auto& chunk : dataChunks)
+            if(chunk.m_rela) chunk.m_rela->swap_symbols( first, second );
+        for(auto& [group, symbol] : groups) {
+            if(symbol == first) symbol = second;
+            else if(symbol == second) symbol = first;
+        }
     } );
+    for(auto& [group, symbol] : groups)
+        group->set_info( symbol );
 
     writer.save(m_output);
 }
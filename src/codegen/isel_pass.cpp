@@ -10,8 +10,8 @@
 #include "target/instruction_info.hpp"
 #include "target/instruction_utils.hpp"
 #include "unit.hpp"
-#include "hash.hpp"
 
+#include <bit>
 #include <deque>
 
 namespace scbe::Codegen {
@@ -794,7 +794,8 @@ MIR::Operand* ISelPass::emitOrGet(ISel::Node* node, MIR::Block* block, bool auto
     auto& match = m_bestMatch.at(node);
     auto res = match.m_pattern->emit(block, m_dataLayout, m_instructionInfo, node, this, m_context);
 
-    m_nodesToMIROperands[node] = res;
+    // global addresses are loaded into a scratch register right where they are used, so every use loads them again
+    if(node->getKind() != ISel::Node::NodeKind::GlobalValue) m_nodesToMIROperands[node] = res;
     return res;
 }
 
@@ -808,31 +809,31 @@ ISel::Register* ISelPass::makeOrGetRegister(IR::Value* referenceValue, Type* typ
 }
 
 ISel::ConstantInt* ISelPass::makeOrGetConstInt(int64_t value, Type* type) {
-    size_t hash = hashValues(value, type);
-    if(m_constantInts.contains(hash)) return m_constantInts[hash];
+    auto key = std::pair(value, type);
+    if(m_constantInts.contains(key)) return m_constantInts[key];
     auto constant = std::make_unique<ISel::ConstantInt>(value, type);
     auto ret = constant.get();
-    m_constantInts[hash] = ret;
+    m_constantInts[key] = ret;
     m_inserter.insert(std::move(constant));
     return ret;
 }
 
 ISel::ConstantFloat* ISelPass::makeOrGetConstFloat(double value, Type* type) {
-    size_t hash = hashValues(value, type);
-    if(m_constantFloats.contains(hash)) return m_constantFloats[hash];
+    auto key = std::pair(std::bit_cast<uint64_t>(value), type);
+    if(m_constantFloats.contains(key)) return m_constantFloats[key];
     auto constant = std::make_unique<ISel::ConstantFloat>(value, type);
     auto ret = constant.get();
-    m_constantFloats[hash] = ret;
+    m_constantFloats[key] = ret;
     m_inserter.insert(std::move(constant));
     return ret;
 }
 
 ISel::FrameIndex* ISelPass::makeOrGetFrameIndex(uint32_t slot, Type* type) {
-    size_t hash = hashValues(slot, type);
-    if(m_frameIndices.contains(hash)) return m_frameIndices[hash];
+    auto key = std::pair(slot, type);
+    if(m_frameIndices.contains(key)) return m_frameIndices[key];
     auto frameIndex = std::make_unique<ISel::FrameIndex>(slot, type);
     auto ret = frameIndex.get();
-    m_frameIndices[hash] = ret;
+    m_frameIndices[key] = ret;
     m_inserter.insert(std::move(frameIndex));
     return ret;
 }
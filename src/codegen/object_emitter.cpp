@@ -11,42 +11,177 @@
 namespace scbe::Codegen {
 
 bool ObjectEmitter::run(MIR::Function* function) {
-    m_codeLocTable.insert({function->getName(), m_codeBytes.size()});
+    size_t codeStart = m_codeBytes.size();
+    size_t fixupStart = m_fixups.size();
+
+    // only symbols of this function are resolved while encoding, anything else goes through a fixup
+    // so the encoded bytes don't depend on where other functions were placed
+    UMap<std::string, size_t> symbols;
+    symbols.insert({function->getName(), codeStart});
+    m_codeLocTable.insert({function->getName(), codeStart});
 
     for(auto& block : function->getBlocks()) {
-        m_codeLocTable.insert({block->getName(), m_codeBytes.size()});
-        
+        symbols.insert({block->getName(), m_codeBytes.size()});
+
         for(size_t i = 0; i < block->getInstructions().size(); i++) {
             MIR::Instruction* instruction = block->getInstructions()[i].get();
-            if(std::optional<Fixup> fixup = m_encoder->encode(instruction, m_codeLocTable, m_codeBytes)) {
+            if(std::optional<Fixup> fixup = m_encoder->encode(instruction, symbols, m_codeBytes)) {
                 m_fixups.push_back(fixup.value());
             }
         }
     }
+
+    resolveLocalFixups(function, codeStart, fixupStart, symbols);
+
+    if(m_cache) {
+        if(auto key = m_cache->getKey(function->getIRFunction()))
+            m_cache->insert(key.value(), createCacheEntry(function, codeStart, fixupStart));
+    }
     return false;
 }
 
+void ObjectEmitter::resolveLocalFixups(MIR::Function* function, size_t codeStart, size_t fixupStart, const UMap<std::string, size_t>& symbols) {
+    // forward branches inside the function are patched here, blocks never reach the symbol table
+    size_t kept = fixupStart;
+    for(size_t i = fixupStart; i < m_fixups.size(); i++) {
+        const Fixup& fixup = m_fixups.at(i);
+        if(fixup.getSection() == Fixup::Text && symbols.contains(fixup.getSymbol())) {
+            int32_t off = symbols.at(fixup.getSymbol()) - (fixup.getLocation() + 4);
+            for(size_t j = 0; j < 4; j++) {
+                m_codeBytes[fixup.getLocation() + j] = off & 0xFF;
+                off >>= 8;
+            }
+            continue;
+        }
+        if(kept != i) m_fixups[kept] = m_fixups.at(i);
+        kept++;
+    }
+    m_fixups.erase(m_fixups.begin() + kept, m_fixups.end());
+
+    // block addresses in data (jump tables) become offsets from the function symbol
+    for(auto& block : function->getBlocks()) {
+        auto it = m_blockDataFixups.find(block->getName());
+        if(it == m_blockDataFixups.end()) continue;
+        for(size_t index : it->second) {
+            const Fixup& fixup = m_fixups.at(index);
+            m_fixups[index] = Fixup(function->getName(), fixup.getLocation(), 0, Fixup::Data, false, fixup.getAddend() + symbols.at(block->getName()) - codeStart);
+        }
+    }
+}
+
 void ObjectEmitter::end(Unit& unit) {
+    if(m_cache) {
+        for(auto& function : unit.getFunctions()) {
+            if(!function->hasBody() || !function->isPrecompiled()) continue;
+            const CachedFunction* entry = m_cache->get(m_cache->getKey(function.get()).value());
+            if(!entry) throw std::runtime_error("Missing cache entry for " + function->getName());
+            spliceCachedFunction(unit, function.get(), *entry);
+        }
+    }
     emitObjectFile(unit);
 }
 
+CachedFunction ObjectEmitter::createCacheEntry(MIR::Function* function, size_t codeStart, size_t fixupStart) {
+    CachedFunction entry;
+    entry.m_code.assign(m_codeBytes.begin() + codeStart, m_codeBytes.end());
+
+    // data created while compiling this function (not in the unit before the pipeline ran) travels with the entry
+    UMap<std::string, size_t> privateData;
+    std::vector<std::string> privateWorklist;
+    auto mapSymbol = [&](const std::string& symbol) {
+        if(!m_dataLocTable.contains(symbol) || m_cache->isSourceGlobal(symbol)) return symbol;
+        if(!privateData.contains(symbol)) {
+            privateData[symbol] = privateWorklist.size();
+            privateWorklist.push_back(symbol);
+        }
+        return CompilationCache::getPrivateDataName(function->getName(), privateData.at(symbol));
+    };
+
+    for(size_t i = fixupStart; i < m_fixups.size(); i++) {
+        const Fixup& fixup = m_fixups.at(i);
+        size_t location = fixup.getLocation() - codeStart;
+        entry.m_fixups.push_back(Fixup(mapSymbol(fixup.getSymbol()), location, fixup.getInstructionSize(), fixup.getSection(), fixup.isFunction(), fixup.getAddend()));
+    }
+
+    for(size_t i = 0; i < privateWorklist.size(); i++) {
+        const DataEntry& dataEntry = m_dataLocTable.at(privateWorklist.at(i));
+        CachedData data;
+        data.m_bytes.assign(m_dataBytes.begin() + dataEntry.m_loc, m_dataBytes.begin() + dataEntry.m_loc + dataEntry.m_size);
+        data.m_readOnly = dataEntry.m_section != DataSection::Data && dataEntry.m_section != DataSection::Zero;
+        for(auto& fixup : m_fixups) {
+            if(fixup.getSection() != Fixup::Data || fixup.getLocation() < dataEntry.m_loc || fixup.getLocation() >= dataEntry.m_loc + dataEntry.m_size) continue;
+            size_t location = fixup.getLocation() - dataEntry.m_loc;
+            data.m_fixups.push_back(Fixup(mapSymbol(fixup.getSymbol()), location, 0, Fixup::Data, fixup.isFunction(), fixup.getAddend()));
+        }
+        entry.m_data.push_back(std::move(data));
+    }
+
+    return entry;
+}
+
+void ObjectEmitter::spliceCachedFunction(Unit& unit, IR::Function* function, const CachedFunction& entry) {
+    size_t codeStart = m_codeBytes.size();
+    m_codeLocTable.insert({function->getName(), codeStart});
+    m_codeBytes.insert(m_codeBytes.end(), entry.m_code.begin(), entry.m_code.end());
+
+    for(size_t i = 0; i < entry.m_data.size(); i++) {
+        const CachedData& data = entry.m_data.at(i);
+        size_t dataStart = m_dataBytes.size();
+        m_dataBytes.insert(m_dataBytes.end(), data.m_bytes.begin(), data.m_bytes.end());
+        DataSection section = classifyData(dataStart, data.m_bytes.size(), data.m_readOnly, false, !data.m_fixups.empty());
+        m_dataLocTable[CompilationCache::getPrivateDataName(function->getName(), i)] = { dataStart, data.m_bytes.size(), IR::Linkage::Internal, section };
+        for(auto& fixup : data.m_fixups)
+            m_fixups.push_back(Fixup(fixup.getSymbol(), fixup.getLocation() + dataStart, 0, Fixup::Data, fixup.isFunction(), fixup.getAddend()));
+    }
+
+    USet<std::string> defined;
+    for(auto& other : unit.getFunctions())
+        if(other->hasBody()) defined.insert(other->getName());
+
+    for(auto& fixup : entry.m_fixups) {
+        // the callers that would have declared these externals during isel were skipped
+        if(!defined.contains(fixup.getSymbol()) && !m_dataLocTable.contains(fixup.getSymbol()))
+            unit.getOrInsertExternal(fixup.getSymbol(), fixup.isFunction() ? MIR::ExternalSymbol::Type::Function : MIR::ExternalSymbol::Type::Variable);
+        m_fixups.push_back(Fixup(fixup.getSymbol(), fixup.getLocation() + codeStart, fixup.getInstructionSize(), fixup.getSection(), fixup.isFunction(), fixup.getAddend()));
+    }
+}
+
 void ObjectEmitter::init(Unit& unit) {
     m_codeBytes.clear();
     m_dataBytes.clear();
     m_fixups.clear();
     m_codeLocTable.clear();
     m_dataLocTable.clear();
+    m_blockDataFixups.clear();
 
     for(auto& globalVariable : unit.getGlobals()) {
         IR::Constant* value = globalVariable->getValue();
         auto l = globalVariable->getLinkage();
 
         if(!value) continue;
-        m_dataLocTable[globalVariable->getName()] = { m_dataBytes.size(), globalVariable->getMachineGlobalAddress(unit) };
+        size_t loc = m_dataBytes.size();
+        size_t fixups = m_fixups.size();
         encodeConstant(value, unit.getDataLayout());
+
+        Type* type = value->getType();
+        bool string = type->isArrayType() && cast<ArrayType>(type)->getElement()->isIntType() && cast<IntegerType>(cast<ArrayType>(type)->getElement())->getBits() == 8;
+        DataSection section = classifyData(loc, m_dataBytes.size() - loc, globalVariable->isReadOnly(), string, m_fixups.size() != fixups);
+        m_dataLocTable[globalVariable->getName()] = { loc, m_dataBytes.size() - loc, l, section };
     }
 }
 
+DataSection ObjectEmitter::classifyData(size_t loc, size_t size, bool readOnly, bool string, bool relocated) const {
+    if(relocated) return readOnly ? DataSection::RelocatedReadOnly : DataSection::Data;
+
+    auto begin = m_dataBytes.begin() + loc;
+    auto end = begin + size;
+    if(!readOnly) return std::all_of(begin, end, [](uint8_t byte) { return byte == 0; }) ? DataSection::Zero : DataSection::Data;
+
+    // merging only works if the string is the whole entry, an inner null would split it
+    if(string && size > 0 && *(end - 1) == 0 && std::find(begin, end - 1, 0) == end - 1) return DataSection::Strings;
+    return DataSection::ReadOnly;
+}
+
 void ObjectEmitter::encodeConstant(IR::Constant* constant, DataLayout* layout) {
     switch (constant->getKind()) {
         case IR::Value::ValueKind::ConstantInt: {
@@ -80,7 +215,17 @@ void ObjectEmitter::encodeConstant(IR::Constant* constant, DataLayout* layout) {
                 encodeConstant(value, layout);
             break;
         }
+        case IR::Value::ValueKind::ConstantDataArray: {
+            const std::vector<uint8_t>& data = cast<IR::ConstantDataArray>(constant)->getData();
+            m_dataBytes.insert(m_dataBytes.end(), data.begin(), data.end());
+            break;
+        }
+        case IR::Value::ValueKind::ConstantAggregateZero:
+            m_dataBytes.resize(m_dataBytes.size() + layout->getSize(constant->getType()), 0);
+            break;
         case IR::Value::ValueKind::Block:
+            m_blockDataFixups[constant->getName()].push_back(m_fixups.size());
+            [[fallthrough]];
         case IR::Value::ValueKind::Function:
         case IR::Value::ValueKind::GlobalVariable: {
             IR::GlobalValue* val = cast<IR::GlobalValue>(constant);
@@ -6,6 +6,8 @@
 #include "type.hpp"
 #include "hash.hpp"
 
+#include <bit>
+
 namespace scbe {
 
 Context::Context() {
@@ -150,21 +152,21 @@ void Context::registerAllTargets() {
 }
 
 IR::ConstantInt* Context::getConstantInt(uint8_t bits, int64_t value) {
-    size_t hash = hashValues(bits, value);
-    if(m_constantIntCache.contains(hash)) return m_constantIntCache.at(hash);
+    auto key = std::pair(bits, value);
+    if(m_constantIntCache.contains(key)) return m_constantIntCache.at(key);
     std::unique_ptr<IR::ConstantInt> constant(new IR::ConstantInt(getIntegerType(bits), value));
     IR::ConstantInt* ret = constant.get();
-    m_constantIntCache.insert({hash, ret});
+    m_constantIntCache.insert({key, ret});
     m_constants.push_back(std::move(constant));
     return ret;
 }
 
 IR::ConstantFloat* Context::getConstantFloat(uint8_t bits, double value) {
-    size_t hash = hashValues(bits, value);
-    if(m_constantFloatCache.contains(hash)) return m_constantFloatCache.at(hash);
+    auto key = std::pair(bits, std::bit_cast<uint64_t>(value));
+    if(m_constantFloatCache.contains(key)) return m_constantFloatCache.at(key);
     std::unique_ptr<IR::ConstantFloat> constant(new IR::ConstantFloat(getFloatType(bits), value));
     IR::ConstantFloat* ret = constant.get();
-    m_constantFloatCache.insert({hash, ret});
+    m_constantFloatCache.insert({key, ret});
     m_constants.push_back(std::move(constant));
     return ret;
 }
@@ -189,6 +191,26 @@ IR::ConstantArray* Context::getConstantArray(ArrayType* type, const std::vector<
     return ret;
 }
 
+IR::ConstantDataArray* Context::getConstantDataArray(ArrayType* type, std::vector<uint8_t> data) {
+    assert((type->getElement()->isIntType() || type->getElement()->isFltType()) && "Data arrays only hold integers and floats");
+
+    std::unique_ptr<IR::ConstantDataArray> constant(new IR::ConstantDataArray(type, std::move(data)));
+    IR::ConstantDataArray* ret = constant.get();
+    assert(ret->getData().size() == ret->getNumElements() * ret->getElementSize() && "Data size mismatch");
+    m_constants.push_back(std::move(constant));
+    return ret;
+}
+
+IR::ConstantAggregateZero* Context::getConstantAggregateZero(Type* type) {
+    assert((type->isStructType() || type->isArrayType()) && "Expected struct or array type");
+    if(m_aggregateZeroCache.contains(type)) return m_aggregateZeroCache.at(type);
+    std::unique_ptr<IR::ConstantAggregateZero> zero(new IR::ConstantAggregateZero(type));
+    IR::ConstantAggregateZero* ret = zero.get();
+    m_aggregateZeroCache.insert({type, ret});
+    m_constants.push_back(std::move(zero));
+    return ret;
+}
+
 IR::ConstantGEP* Context::getConstantGEP(IR::Constant* base, const std::vector<IR::ConstantInt*>& indices) {
     assert((base->getType()->isPtrType() || base->getType()->isArrayType()) && "Expected pointer or array value");
 
@@ -229,13 +251,13 @@ IR::NullValue* Context::getNullValue(Type* type) {
 }
 
 MIR::ImmediateInt* Context::getImmediateInt(int64_t value, MIR::ImmediateInt::Size size, int64_t flags) {
-    size_t hash = hashValues(value, size, flags);
-    if(m_immediateIntCache.contains(hash)) return m_immediateIntCache.at(hash);
+    auto key = std::tuple(value, size, flags);
+    if(m_immediateIntCache.contains(key)) return m_immediateIntCache.at(key);
     std::unique_ptr<MIR::ImmediateInt> immediate(new MIR::ImmediateInt(value, size));
     immediate->setFlags(flags);
     MIR::ImmediateInt* ret = immediate.get();
     m_immediates.push_back(std::move(immediate));
-    m_immediateIntCache.insert({hash, ret});
+    m_immediateIntCache.insert({key, ret});
     return ret;
 }
 
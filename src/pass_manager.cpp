@@ -5,66 +5,81 @@
 #include "IR/block.hpp"
 #include "MIR/function.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 namespace scbe {
 
 void PassManager::run(Unit& unit) {
     for(size_t i = 0; i < m_groups.size();) {
         bool anyChange = false;
         for(auto& pass : m_groups.at(i).m_passes) {
-            pass->init(unit);
-            switch (pass->getKind()) {
-                case Pass::Kind::Function:
-                    for(auto& function : unit.m_functions) {
-                        if(!function->hasBody()) continue;
-                        anyChange |= ((FunctionPass*)pass.get())->run(function.get());
-                    }
-                    break;
-                case Pass::Kind::MachineFunction:
-                    for(auto& function : unit.m_functions) {
-                        if(!function->hasBody()) continue;
-                        anyChange |= ((MachineFunctionPass*)pass.get())->run(function->getMachineFunction());
-                    }
-                    break;
-                case Pass::Kind::Instruction: {
-                    InstructionPass* ipass = (InstructionPass*)pass.get();
-                    for(auto& function : unit.m_functions) {
-                        if(!function->hasBody()) continue;
-                        for(auto& block : function->getBlocks()) {
-                            do {
-                                ipass->m_restart = false;
-                                for(auto& instruction : block->getInstructions()) {
-                                    anyChange |= ipass->run(instruction.get());
-                                    if(ipass->m_restart) break;
-                                }
-                            } while(ipass->m_restart);
+            auto begin = std::chrono::steady_clock::now();
+            runPass(pass.get(), unit, anyChange);
+            if(m_timePasses) {
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+                auto it = std::find_if(m_timings.begin(), m_timings.end(), [&](auto& timing) { return timing.first == pass->getName(); });
+                if(it == m_timings.end()) m_timings.push_back({pass->getName(), elapsed});
+                else it->second += elapsed;
+            }
+            if(m_afterPass) m_afterPass(pass.get(), unit);
+        }
+        if(anyChange && m_groups.at(i).m_repeat) continue;
+        i++;
+    }
+}
+
+void PassManager::runPass(Pass* pass, Unit& unit, bool& anyChange) {
+    pass->init(unit);
+    switch (pass->getKind()) {
+        case Pass::Kind::Function:
+            for(auto& function : unit.m_functions) {
+                if(!function->hasBody() || function->isPrecompiled()) continue;
+                anyChange |= ((FunctionPass*)pass)->run(function.get());
+            }
+            break;
+        case Pass::Kind::MachineFunction:
+            for(auto& function : unit.m_functions) {
+                if(!function->hasBody() || function->isPrecompiled()) continue;
+                anyChange |= ((MachineFunctionPass*)pass)->run(function->getMachineFunction());
+            }
+            break;
+        case Pass::Kind::Instruction: {
+            InstructionPass* ipass = (InstructionPass*)pass;
+            for(auto& function : unit.m_functions) {
+                if(!function->hasBody() || function->isPrecompiled()) continue;
+                for(auto& block : function->getBlocks()) {
+                    do {
+                        ipass->m_restart = false;
+                        for(auto& instruction : block->getInstructions()) {
+                            anyChange |= ipass->run(instruction.get());
+                            if(ipass->m_restart) break;
                         }
-                    }
-                    break;
+                    } while(ipass->m_restart);
                 }
-                case Pass::Kind::MachineInstruction: {
-                    MachineInstructionPass* ipass = (MachineInstructionPass*)pass.get();
-                    for(auto& function : unit.m_functions) {
-                        if(!function->hasBody()) continue;
-                        for(auto& block : function->getMachineFunction()->getBlocks()) {
-                            do {
-                                ipass->m_restart = false;
-                                for(auto& instruction : block->getInstructions()) {
-                                    anyChange |= ipass->run(instruction.get());
-                                    if(ipass->m_restart) break;
-                                }
-                            } while(ipass->m_restart);
+            }
+            break;
+        }
+        case Pass::Kind::MachineInstruction: {
+            MachineInstructionPass* ipass = (MachineInstructionPass*)pass;
+            for(auto& function : unit.m_functions) {
+                if(!function->hasBody() || function->isPrecompiled()) continue;
+                for(auto& block : function->getMachineFunction()->getBlocks()) {
+                    do {
+                        ipass->m_restart = false;
+                        for(auto& instruction : block->getInstructions()) {
+                            anyChange |= ipass->run(instruction.get());
+                            if(ipass->m_restart) break;
                         }
-                    }
-                    break;
+                    } while(ipass->m_restart);
                 }
-                default:
-                    break;
             }
-            pass->end(unit);
+            break;
         }
-        if(anyChange && m_groups.at(i).m_repeat) continue;
-        i++;
+        default:
+            break;
     }
+    pass->end(unit);
 }
 
 }
\ No newline at end of file
@@ -7,6 +7,8 @@ using namespace scbe::Target::AArch64;
 
 namespace scbe::Target {
 
+namespace {
+
 struct ArgAssignmentState {
     size_t m_usedGPR = 0;
     size_t m_usedFPR = 0;
@@ -21,6 +23,8 @@ struct ArgAssignmentState {
     RegisterId nextFPR() { return FPRs[m_usedFPR++]; }
 };
 
+}
+
 void CCAArch64AAPCS64(CallInfo& info, const std::vector<Type*>& types, bool isVarArg) {
     ArgAssignmentState state;
 
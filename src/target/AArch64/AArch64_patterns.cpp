@@ -203,6 +203,12 @@ MIR::Operand* emitStoreInPtrRegister(EMITTER_ARGS) {
     auto rr = cast<MIR::Register>(isel->emitOrGet(i->getOperands().at(0), block));
     AArch64InstructionInfo* aInstrInfo = (AArch64InstructionInfo*)instrInfo;
     MIR::Register* to = nullptr;
+    if(rr->getId() == instrInfo->getRegisterInfo()->getReservedRegisters(GPR64).back() && (from->isImmediateInt() || from->isFrameIndex())) {
+        // globals come in the scratch register, which the stored immediate or address needs too
+        MIR::Register* copy = instrInfo->getRegisterInfo()->getRegister(block->getParentFunction()->getRegisterInfo().getNextVirtualRegister(GPR64));
+        instrInfo->move(block, block->last(), rr, copy, 8, false);
+        rr = copy;
+    }
     if(from->isImmediateInt()) {
         from = aInstrInfo->getImmediate(block, cast<MIR::ImmediateInt>(from));
         if(from->isImmediateInt()) {
@@ -1095,7 +1101,9 @@ MIR::Operand* emitConstantFloat(EMITTER_ARGS) {
     RegisterInfo* ri = instrInfo->getRegisterInfo();
 
     MIR::Register* returnReg = ri->getRegister(ri->getReservedRegisters(ftype->getBits() == 64 ? FPR64 : FPR32).back());
-    MIR::GlobalAddress* symbol = unit->getOrInsertGlobalVariable(cnst->getType(), cnst, IR::Linkage::Internal)->getMachineGlobalAddress(*unit);
+    IR::GlobalVariable* pool = unit->getOrInsertGlobalVariable(cnst->getType(), cnst, IR::Linkage::Internal);
+    pool->setReadOnly(true);
+    MIR::GlobalAddress* symbol = pool->getMachineGlobalAddress(*unit);
     AArch64InstructionInfo* aInstrInfo = (AArch64InstructionInfo*)instrInfo;
     
     aInstrInfo->getSymbolValue(block, block->last(), symbol, returnReg);
@@ -1120,6 +1128,12 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
         RegisterInfo* ri = instrInfo->getRegisterInfo();
         base = ri->getRegister(X29);
     }
+    else if(cast<MIR::Register>(base)->getId() == instrInfo->getRegisterInfo()->getReservedRegisters(GPR64).back()) {
+        // globals come in the scratch register, which the scale and offset immediates need too
+        MIR::Register* copy = instrInfo->getRegisterInfo()->getRegister(block->getParentFunction()->getRegisterInfo().getNextVirtualRegister(GPR64));
+        instrInfo->move(block, block->last(), base, copy, 8, false);
+        base = copy;
+    }
 
     for(size_t idx = 1; idx < i->getOperands().size(); idx++) {
         MIR::Operand* index = isel->emitOrGet(i->getOperands().at(idx), block);
@@ -1142,7 +1156,6 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
             index = block->getParentFunction()->cloneOpWithFlags(index, Force64BitRegister);
             instrInfo->move(block, block->last(), index, tmp, 8, false);
             index = tmp;
-            curOff = 0;
             Type* ty = curType->getContainedTypes().at(0);
             size_t scale = ty->isArrayType() ? layout->getPointerSize() : layout->getSize(ty);
             MIR::Operand* scaleOp = aInstrInfo->getImmediate(block, context->getImmediateInt(scale, MIR::ImmediateInt::imm64));
@@ -1154,11 +1167,16 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
                 scaleOp = tmp;
             }
             block->addInstruction(instr((uint32_t)Opcode::Mul64rr, index, index, scaleOp));
-            block->addInstruction(instr((uint32_t)Opcode::Add64rr, base, base, index));
+            // accumulate into a new register, the base may still be live or be the frame pointer
+            MIR::Register* sum = instrInfo->getRegisterInfo()->getRegister(block->getParentFunction()->getRegisterInfo().getNextVirtualRegister(GPR64));
+            block->addInstruction(instr((uint32_t)Opcode::Add64rr, sum, base, index));
+            base = sum;
         }
     }
 
+    // the offset is added to a pointer, so a materialized one must be 64 bit too
     auto size = immSizeFromValue(curOff);
+    if(size != MIR::ImmediateInt::imm8) size = MIR::ImmediateInt::imm64;
     MIR::Operand* off = nullptr;
     uint32_t opcode = 0;
     Ref<Context> ctx = block->getParentFunction()->getIRFunction()->getUnit()->getContext();
@@ -1166,16 +1184,15 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
         if(curOff < 0) {
             curOff *= -1;
             off = ((AArch64InstructionInfo*)instrInfo)->getImmediate(block, ctx->getImmediateInt(curOff, size));
-            if(off->isRegister()) opcode = size <= 4 ? OPCODE(Sub32rr) : OPCODE(Sub64rr);
-            else opcode = size <= 4 ? OPCODE(Sub32ri) : OPCODE(Sub64ri);
+            opcode = off->isRegister() ? OPCODE(Sub64rr) : OPCODE(Sub64ri);
         }
         else {
             off = ((AArch64InstructionInfo*)instrInfo)->getImmediate(block, ctx->getImmediateInt(curOff, size));
-            if(off->isRegister()) opcode = size <= 4 ? OPCODE(Add32rr) : OPCODE(Add64rr);
-            else opcode = size <= 4 ? OPCODE(Add32ri) : OPCODE(Add64ri);
+            opcode = off->isRegister() ? OPCODE(Add64rr) : OPCODE(Add64ri);
         }
         block->addInstruction(instr(opcode, ret, cast<MIR::Register>(base), off));
     }
+    else instrInfo->move(block, block->last(), base, ret, 8, false);
 
     return ret;
 }
@@ -285,6 +285,7 @@ void AArch64TargetLowering::lowerSwitch(MIR::Block* block, MIR::SwitchLowering*
 
     IR::ConstantArray* array = unit->getContext()->getConstantArray(unit->getContext()->makeArrayType(voidPtr, table.size()), table);
     IR::GlobalVariable* var = unit->getOrInsertGlobalVariable(voidPtr, array, IR::Linkage::Internal);
+    var->setReadOnly(true);
 
     MIR::GlobalAddress* addr = var->getMachineGlobalAddress(*unit);
     AArch64InstructionInfo* aInstrInfo = (AArch64InstructionInfo*)m_instructionInfo;
@@ -180,6 +180,9 @@ std::optional<Codegen::Fixup> x64InstructionEncoder::encode(MIR::Instruction* in
 
         if(!(encoding.m_immediate && ops.size() == 1))
             bytes.push_back(encodeModRM(mod, encoding.m_instructionVariant ? *encoding.m_instructionVariant : (reg & 0x7), (rm == 0b100 || rm == 0b101 ? rm : rm & 0x7)));
+        // the SIB byte sits between ModRM and the displacement
+        if(hasSIB)
+            bytes.push_back(encodeSIB(scale, index, base));
 
         if(hasDisp) {
             if(mod == 0b01)
@@ -205,8 +208,6 @@ std::optional<Codegen::Fixup> x64InstructionEncoder::encode(MIR::Instruction* in
                 imm >>= 8;
             }
         }
-        if(hasSIB)
-            bytes.push_back(encodeSIB(scale, index, base));
     }
     else if(encoding.m_operandType == InstructionEncoding::Symbol) {
         uint32_t instructionAddress = bytes.size();
@@ -222,7 +223,7 @@ std::optional<Codegen::Fixup> x64InstructionEncoder::encode(MIR::Instruction* in
         else
             loc = symbols.at(symbol->getName());
 
-        int32_t rel32 = int32_t(loc) - int32_t(instructionAddress + 5);
+        int32_t rel32 = int32_t(loc) - int32_t(instructionAddress + instructionSize);
 
         for(size_t i = 0; i < 4; i++) {
             bytes.push_back(rel32 & 0xFF);
@@ -250,7 +251,7 @@ uint8_t x64InstructionEncoder::encodeModRM(uint8_t mod, uint8_t reg, uint8_t rm)
 }
 
 uint8_t x64InstructionEncoder::encodeSIB(uint8_t scale, uint8_t index, uint8_t base) const {
-    return (scale << 6) | (index << 3) | base;
+    return (scale << 6) | ((index & 0x7) << 3) | (base & 0x7);
 }
 
 uint8_t x64InstructionEncoder::encodeRegister(uint32_t reg) const {
@@ -205,7 +205,7 @@ void x64AsmPrinter::print(IR::Constant* constant) {
             for(size_t i = 0; i < arr->getValues().size() - 1; i++) {
                 valueStr += cast<IR::ConstantInt>(arr->getValues().at(i))->getValue();
             }
-            m_output << ".asciz \"" << escapeString(valueStr) << "\"";
+            m_output << ".asciz \"" << escapeAssemblyString(valueStr) << "\"";
         }
         else {
             for(auto& value : arr->getValues()) {
@@ -214,6 +214,34 @@ void x64AsmPrinter::print(IR::Constant* constant) {
             }
         }
     }
+    else if(constant->isConstantDataArray()) {
+        auto arr = cast<IR::ConstantDataArray>(constant);
+        auto elty = arr->getElementType();
+
+        if(arr->isString()) {
+            std::string valueStr = arr->getAsString();
+            valueStr.pop_back();
+            m_output << ".asciz \"" << escapeAssemblyString(valueStr) << "\"";
+        }
+        else if(elty->isIntType() && cast<IntegerType>(elty)->getBits() == 8) {
+            m_output << ".ascii \"" << escapeAssemblyString(arr->getAsString()) << "\"";
+        }
+        else {
+            static const char* directives[] = { ".byte ", ".short ", ".long ", ".quad " };
+            size_t size = arr->getElementSize();
+            for(size_t i = 0; i < arr->getNumElements(); i++) {
+                if(elty->isFltType()) {
+                    m_output << (size == 4 ? ".float " : ".double ") << std::fixed << std::setprecision(size == 4 ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::max_digits10)
+                        << arr->getElementAsFloat(i);
+                }
+                else m_output << directives[size == 1 ? 0 : size == 2 ? 1 : size == 4 ? 2 : 3] << arr->getElementAsInt(i);
+                m_output << "\n";
+            }
+        }
+    }
+    else if(constant->isConstantAggregateZero()) {
+        m_output << ".zero " << m_dataLayout->getSize(constant->getType());
+    }
     else if(constant->isFunction()) {
         m_output << ".quad " << cast<IR::Function>(constant)->getMachineFunction()->getName();
     }
@@ -5,6 +5,8 @@ using namespace scbe::Target::x64;
 
 namespace scbe::Target {
 
+namespace {
+
 struct ArgAssignmentState {
     ArgAssignmentState(const std::vector<RegisterId>& gprs, const std::vector<RegisterId>& fprs) : GPRs(gprs), FPRs(fprs) {}
     
@@ -21,6 +23,8 @@ struct ArgAssignmentState {
     RegisterId nextFPR() { return FPRs[m_usedFPR++]; }
 };
 
+}
+
 void CCx64SysV(CallInfo& info, const std::vector<Type*>& types, bool isVarArg) {
     ArgAssignmentState state(
         {RDI, RSI, RDX, RCX, R8, R9},
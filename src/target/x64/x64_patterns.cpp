@@ -1041,8 +1041,9 @@ MIR::Operand* emitConstantFloat(EMITTER_ARGS) {
     MIR::Operand* rr = ri->getRegister(ri->getReservedRegisters(FPR).back());
     x64InstructionInfo* xInstrInfo = (x64InstructionInfo*)instrInfo;
     uint32_t op = ftype->getBits() == 32 ? OPCODE(Movssrm) : OPCODE(Movsdrm);
-    block->addInstruction(xInstrInfo->memoryToOperand(op, rr, ri->getRegister(RIP), 0, nullptr, 1,
-        unit->getOrInsertGlobalVariable(cnst->getType(), cnst, IR::Linkage::Internal)->getMachineGlobalAddress(*unit)));
+    IR::GlobalVariable* pool = unit->getOrInsertGlobalVariable(cnst->getType(), cnst, IR::Linkage::Internal);
+    pool->setReadOnly(true);
+    block->addInstruction(xInstrInfo->memoryToOperand(op, rr, ri->getRegister(RIP), 0, nullptr, 1, pool->getMachineGlobalAddress(*unit)));
     return rr;
 }
 
@@ -1078,7 +1079,6 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
         }
         else {
             x64InstructionInfo* xInstrInfo = (x64InstructionInfo*)instrInfo;
-            curOff = 0;
             Type* ty = curType->getContainedTypes().at(0);
             size_t scale = ty->isArrayType() ? layout->getPointerSize() : layout->getSize(ty);
             if(scale > 8) {
@@ -1096,8 +1096,10 @@ MIR::Operand* emitGEP(EMITTER_ARGS) {
             }
             uint32_t rclass = instrInfo->getRegisterInfo()->getRegisterIdClass(cast<MIR::Register>(index)->getId(), block->getParentFunction()->getRegisterInfo());
             if(rclass != GPR64) index = block->getParentFunction()->cloneOpWithFlags(index, Force64BitRegister);
-            block->addInstruction(xInstrInfo->memoryToOperand(OPCODE(Lea64rm), ret, cast<MIR::Register>(base), 0, cast<MIR::Register>(index), scale, nullptr));
+            // the offset so far goes into the same lea, including the frame slot offset
+            block->addInstruction(xInstrInfo->memoryToOperand(OPCODE(Lea64rm), ret, cast<MIR::Register>(base), curOff, cast<MIR::Register>(index), scale, nullptr));
             base = ret;
+            curOff = 0;
         }
     }
 
@@ -357,6 +357,7 @@ void x64TargetLowering::lowerSwitch(MIR::Block* block, MIR::SwitchLowering* lowe
 
     IR::ConstantArray* array = unit->getContext()->getConstantArray(unit->getContext()->makeArrayType(voidPtr, table.size()), table);
     IR::GlobalVariable* var = unit->getOrInsertGlobalVariable(voidPtr, array, IR::Linkage::Internal);
+    var->setReadOnly(true);
 
     MIR::GlobalAddress* addr = var->getMachineGlobalAddress(*unit);
     x64InstructionInfo* xInstrInfo = (x64InstructionInfo*)m_instructionInfo;
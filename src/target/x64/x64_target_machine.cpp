@@ -6,6 +6,7 @@
 #include "IR/mem2reg.hpp"
 #include "IR/split_critical_edge.hpp"
 #include "codegen/coff_object_emitter.hpp"
+#include "codegen/compilation_cache.hpp"
 #include "codegen/elf_object_emitter.hpp"
 #include "codegen/graph_color_regalloc.hpp"
 #include "codegen/isel_pass.hpp"
@@ -84,6 +85,10 @@ class x64DataLayout : public DataLayout {
 };
 
 void x64TargetMachine::addPassesForCodeGeneration(Ref<PassManager> passManager, std::ofstream& output, FileType type, OptimizationLevel level) {
+    Ref<Codegen::CompilationCache> cache = type == FileType::ObjectFile ? m_cache : nullptr;
+    if(cache)
+        passManager->addRun({std::make_shared<Codegen::CompilationCacheLookup>(cache, m_spec, level)}, false);
+
     if(level >= OptimizationLevel::O1) {
         passManager->addRun({
             std::make_shared<IR::FunctionInlining>(),
@@ -109,18 +114,22 @@ void x64TargetMachine::addPassesForCodeGeneration(Ref<PassManager> passManager,
     else {
         if(m_spec.getOS() == OS::Linux) {
             passManager->addRun({std::make_shared<Codegen::ELFObjectEmitter>(
-                output, std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo()
+                output, std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo(), cache, m_objectFileOptions
             )}, false);
         }
         else {
             passManager->addRun({std::make_shared<Codegen::COFFObjectEmitter>(
-                output, std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo()
+                output, std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo(), cache
             )}, false);
         }
     }
 }
 
 void x64TargetMachine::addPassesForCodeGeneration(Ref<PassManager> passManager, std::initializer_list<std::reference_wrapper<std::ofstream>> files, std::initializer_list<FileType> type, OptimizationLevel level) {
+    Ref<Codegen::CompilationCache> cache = std::find(type.begin(), type.end(), FileType::AssemblyFile) == type.end() ? m_cache : nullptr;
+    if(cache)
+        passManager->addRun({std::make_shared<Codegen::CompilationCacheLookup>(cache, m_spec, level)}, false);
+
     if(level >= OptimizationLevel::O1) {
         passManager->addRun({
             std::make_shared<IR::FunctionInlining>(),
@@ -147,12 +156,12 @@ void x64TargetMachine::addPassesForCodeGeneration(Ref<PassManager> passManager,
         else {
             if(m_spec.getOS() == OS::Linux) {
                 passManager->addRun({std::make_shared<Codegen::ELFObjectEmitter>(
-                    files.begin()[i].get(), std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo()
+                    files.begin()[i].get(), std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo(), cache, m_objectFileOptions
                 )}, false);
             }
             else {
                 passManager->addRun({std::make_shared<Codegen::COFFObjectEmitter>(
-                    files.begin()[i].get(), std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo()
+                    files.begin()[i].get(), std::make_shared<x64InstructionEncoder>(getInstructionInfo(), m_spec), getInstructionInfo(), cache
                 )}, false);
             }
         }
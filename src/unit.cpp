@@ -68,8 +68,10 @@ MIR::GlobalAddress* Unit::getOrInsertGlobalAddress(IR::GlobalValue* value, int64
 }
 
 IR::GlobalVariable* Unit::createGlobalString(const std::string& value) {
-    IR::ConstantArray* constant = IR::ConstantArray::fromString(value, m_ctx);
-    return getOrInsertGlobalVariable(m_ctx->makePointerType(constant->getType()), constant, IR::Linkage::External);
+    IR::ConstantDataArray* constant = IR::ConstantDataArray::fromString(value, m_ctx);
+    IR::GlobalVariable* global = getOrInsertGlobalVariable(m_ctx->makePointerType(constant->getType()), constant, IR::Linkage::External);
+    global->setReadOnly(true);
+    return global;
 }
 
 size_t Unit::getIRInstructionSize() const {
@@ -0,0 +1,195 @@
+#include "cases/cases.hpp"
+#include "context.hpp"
+#include "IR/block.hpp"
+#include "IR/builder.hpp"
+#include "IR/bitcode_reader.hpp"
+#include "IR/bitcode_writer.hpp"
+#include "IR/printer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <algorithm>
+#include <sstream>
+
+using namespace scbe;
+
+static void buildBitcodeUnit(Unit& unit) {
+    auto ctx = unit.getContext();
+    auto i8 = ctx->getI8Type();
+    auto i32 = ctx->getI32Type();
+    IR::Builder builder(ctx);
+
+    auto pairTy = ctx->makeStructType({i32, ctx->makeArrayType(i8, 2)}, "Pair");
+    auto tableTy = ctx->makeArrayType(i32, 5);
+    std::vector<IR::Constant*> elements;
+    for(int64_t value : {10, -20, 30, 40, 50}) elements.push_back(IR::ConstantInt::get(32, value, ctx));
+    auto table = unit.getOrInsertGlobalVariable(ctx->makePointerType(tableTy), IR::ConstantArray::get(tableTy, elements, ctx), IR::Linkage::External, "table");
+    auto text = unit.createGlobalString("hi!");
+    auto pairValue = IR::ConstantStruct::get(pairTy, {IR::ConstantInt::get(32, 7, ctx), IR::ConstantArray::get(ctx->makeArrayType(i8, 2), {IR::ConstantInt::get(8, 0, ctx), IR::ConstantInt::get(8, 0, ctx)}, ctx)}, ctx);
+    auto pair = unit.getOrInsertGlobalVariable(ctx->makePointerType(pairTy), pairValue, IR::Linkage::External, "pair");
+    unit.getOrInsertGlobalVariable(ctx->makePointerType(ctx->getF64Type()), IR::ConstantFloat::get(64, 0.5, ctx), IR::Linkage::External, "half");
+
+    auto pick = unit.getOrInsertFunction("pick", ctx->makeFunctionType({i32}, i32), IR::Linkage::Internal);
+    auto pickEntry = pick->insertBlock("entry");
+    auto zero = pick->insertBlock("zero");
+    auto three = pick->insertBlock("three");
+    auto other = pick->insertBlock("other");
+    builder.setCurrentBlock(pickEntry);
+    builder.createSwitch(pick->getArguments().at(0).get(), other, {{IR::ConstantInt::get(32, 0, ctx), zero}, {IR::ConstantInt::get(32, 3, ctx), three}});
+    builder.setCurrentBlock(zero);
+    builder.createRet(IR::ConstantInt::get(32, 1, ctx));
+    builder.setCurrentBlock(three);
+    auto element = builder.createGEP(table, {IR::ConstantInt::get(64, 0, ctx), IR::ConstantInt::get(64, 3, ctx)});
+    builder.createRet(builder.createLoad(element));
+    builder.setCurrentBlock(other);
+    builder.createRet(IR::ConstantInt::get(32, 2, ctx));
+
+    auto main = unit.getOrInsertFunction("main", ctx->makeFunctionType({}, i32), IR::Linkage::External);
+    auto entry = main->insertBlock("entry");
+    auto head = main->insertBlock("head");
+    auto body = main->insertBlock("body");
+    auto done = main->insertBlock("done");
+    builder.setCurrentBlock(entry);
+    auto i = builder.createAllocate(i32, "i");
+    auto sum = builder.createAllocate(i32, "s");
+    builder.createStore(i, IR::ConstantInt::get(32, 0, ctx));
+    builder.createStore(sum, builder.createCall(pick, {IR::ConstantInt::get(32, 3, ctx)}));
+    builder.createJump(head);
+    builder.setCurrentBlock(head);
+    builder.createCondJump(body, done, builder.createICmpLt(builder.createLoad(i), IR::ConstantInt::get(32, 4, ctx)));
+    builder.setCurrentBlock(body);
+    auto field = builder.createGEP(pair, {IR::ConstantInt::get(32, 0, ctx), IR::ConstantInt::get(32, 0, ctx)});
+    builder.createStore(sum, builder.createAdd(builder.createLoad(sum), builder.createLoad(field)));
+    builder.createStore(i, builder.createAdd(builder.createLoad(i), IR::ConstantInt::get(32, 1, ctx)));
+    builder.createJump(head);
+    builder.setCurrentBlock(done);
+    auto character = builder.createGEP(text, {IR::ConstantInt::get(64, 0, ctx), IR::ConstantInt::get(64, 1, ctx)});
+    auto widened = builder.createZext(builder.createLoad(character), i32);
+    builder.createRet(builder.createAdd(builder.createLoad(sum), widened));
+}
+
+static std::vector<uint8_t> writeBitcode(Unit& unit) {
+    std::stringstream stream;
+    IR::BitcodeWriter(stream).write(unit);
+    std::string bytes = stream.str();
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+static std::unique_ptr<Unit> readBitcode(std::vector<uint8_t> bytes, Ref<Context> context) {
+    IR::BitcodeReader reader(std::move(bytes));
+    auto unit = std::make_unique<Unit>(reader.getUnitName(), context);
+    reader.readInto(*unit);
+    reader.materializeAll();
+    return unit;
+}
+
+static IR::Function* findFunction(Unit& unit, const std::string& name) {
+    for(auto& function : unit.getFunctions())
+        if(function->getName() == name) return function.get();
+    return nullptr;
+}
+
+static std::string printUnit(Unit& unit) {
+    std::stringstream stream;
+    IR::HumanPrinter(stream).print(unit);
+    return stream.str();
+}
+
+TEST_CASE("Bitcode round trip") {
+    auto debug = GENERATE(0, 1, 2);
+    CAPTURE(debug);
+
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    Unit original = createUnit("bitcode");
+    buildBitcodeUnit(original);
+    auto bytes = writeBitcode(original);
+    auto unit = readBitcode(bytes, original.getContext());
+
+    REQUIRE(unit->getName() == "bitcode");
+    REQUIRE(printUnit(*unit) == printUnit(original));
+    // writing what was read gives back the same file
+    REQUIRE(writeBitcode(*unit) == bytes);
+
+    auto program = compileUnit(*unit, spec, debug);
+    REQUIRE(program);
+    // 40 + 4 * 7 + 'i'
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 173));
+}
+
+TEST_CASE("Bitcode lazy materialization") {
+    Unit original = createUnit("bitcode");
+    buildBitcodeUnit(original);
+    IR::BitcodeReader reader(writeBitcode(original));
+    Unit unit(reader.getUnitName(), original.getContext());
+    reader.readInto(unit);
+
+    IR::Function* pick = findFunction(unit, "pick");
+    IR::Function* main = findFunction(unit, "main");
+    REQUIRE(pick);
+    REQUIRE(main);
+    REQUIRE(reader.isMaterializable(pick));
+    REQUIRE(pick->getBlocks().empty());
+
+    reader.materialize(main);
+    REQUIRE(!main->getBlocks().empty());
+    REQUIRE(reader.isMaterializable(pick));
+    REQUIRE(!reader.isMaterializable(main));
+}
+
+TEST_CASE("Bitcode truncation") {
+    Unit original = createUnit("bitcode");
+    buildBitcodeUnit(original);
+    auto bytes = writeBitcode(original);
+
+    // every prefix of the file is rejected with an error instead of read past its end
+    for(size_t size = 0; size < bytes.size(); size++) {
+        CAPTURE(size);
+        REQUIRE_THROWS_AS(readBitcode(std::vector<uint8_t>(bytes.begin(), bytes.begin() + size), original.getContext()), std::runtime_error);
+    }
+}
+
+TEST_CASE("Bitcode corruption") {
+    Unit original = createUnit("bitcode");
+    buildBitcodeUnit(original);
+    auto bytes = writeBitcode(original);
+
+    // a damaged byte either still reads as some unit or is reported, it never crashes the reader
+    for(size_t offset = 0; offset < bytes.size(); offset++) {
+        for(uint8_t value : {(uint8_t)0x00, (uint8_t)0x7F, (uint8_t)0xFF}) {
+            if(bytes.at(offset) == value) continue;
+            CAPTURE(offset, (int)value);
+            auto corrupted = bytes;
+            corrupted[offset] = value;
+            try {
+                readBitcode(std::move(corrupted), original.getContext());
+            }
+            catch(const std::runtime_error& error) {
+                REQUIRE(std::string(error.what()).size() > 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Bitcode rejects invalid enumerators") {
+    Unit original = createUnit("enums");
+    auto ctx = original.getContext();
+    auto main = original.getOrInsertFunction("main", ctx->makeFunctionType({}, ctx->getI32Type()), IR::Linkage::External);
+    IR::Builder builder(ctx);
+    builder.setCurrentBlock(main->insertBlock("entry"));
+    builder.createRet(IR::ConstantInt::get(32, 0, ctx));
+    auto bytes = writeBitcode(original);
+
+    // the header is magic, version, name, then the type count and the first type kind
+    size_t kind = 8 + 1 + std::string("enums").size() + 1;
+    auto corrupted = bytes;
+    corrupted[kind] = 0x7F;
+    REQUIRE_THROWS_AS(readBitcode(corrupted, original.getContext()), std::runtime_error);
+
+    // the only body is the entry block's name and instruction count followed by the ret
+    std::string name = "entry";
+    auto found = std::find_end(bytes.begin(), bytes.end(), name.begin(), name.end());
+    REQUIRE(found != bytes.end());
+    corrupted = bytes;
+    corrupted[found - bytes.begin() + name.size() + 1] = (uint8_t)IR::Instruction::Opcode::Count;
+    REQUIRE_THROWS_AS(readBitcode(corrupted, original.getContext()), std::runtime_error);
+}
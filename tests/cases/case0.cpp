@@ -10,7 +10,7 @@ bool case0(Target::TargetSpecification& spec, int debug) {
     Unit unit = createUnit("case0");
     auto ctx = unit.getContext();
     auto fnTy = ctx->makeFunctionType({}, ctx->getI32Type());
-    auto main = unit.addFunction(std::move(std::make_unique<IR::Function>("main", fnTy, IR::Linkage::External)));
+    auto main = unit.getOrInsertFunction("main", fnTy, IR::Linkage::External);
 
     IR::Builder builder (ctx);
 
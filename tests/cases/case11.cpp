@@ -11,13 +11,13 @@ bool case11(Target::TargetSpecification& spec, int debug) {
     Unit unit = createUnit("case11");
     auto ctx = unit.getContext();
     auto fnTy = ctx->makeFunctionType({}, ctx->getI32Type());
-    auto main = unit.addFunction(std::move(std::make_unique<IR::Function>("main", fnTy, IR::Linkage::External)));
+    auto main = unit.getOrInsertFunction("main", fnTy, IR::Linkage::External);
 
     IR::Builder builder(ctx);
     auto entry = main->insertBlock("entry");
     builder.setCurrentBlock(entry);
 
-    auto gstr = unit.createGlobalString("Z_rest", "gstr");
+    auto gstr = unit.createGlobalString("Z_rest");
     auto ptrToInt = builder.createPtrtoint(gstr, ctx->getI64Type());
     auto intToPtr = builder.createInttoptr(ptrToInt, ctx->makePointerType(ctx->getI8Type()));
     auto loaded = builder.createLoad(intToPtr);
@@ -11,7 +11,7 @@ bool case13(Target::TargetSpecification& spec, int debug) {
     Unit unit = createUnit("case13");
     auto ctx = unit.getContext();
     auto fnTy = ctx->makeFunctionType({}, ctx->getI32Type());
-    auto main = unit.addFunction(std::move(std::make_unique<IR::Function>("main", fnTy, IR::Linkage::External)));
+    auto main = unit.getOrInsertFunction("main", fnTy, IR::Linkage::External);
 
     IR::Builder builder(ctx);
     auto entry = main->insertBlock("entry");
@@ -11,7 +11,7 @@ bool case9(Target::TargetSpecification& spec, int debug) {
     Unit unit = createUnit("case9");
     auto ctx = unit.getContext();
     auto fnTyCallee = ctx->makeFunctionType({}, ctx->getI32Type());
-    auto callee = unit.addFunction(std::move(std::make_unique<IR::Function>("callee", fnTyCallee, IR::Linkage::External)));
+    auto callee = unit.getOrInsertFunction("callee", fnTyCallee, IR::Linkage::External);
 
     {
         IR::Builder b(ctx);
@@ -21,7 +21,7 @@ bool case9(Target::TargetSpecification& spec, int debug) {
     }
 
     auto fnTyMain = ctx->makeFunctionType({}, ctx->getI32Type());
-    auto main = unit.addFunction(std::move(std::make_unique<IR::Function>("main", fnTyMain, IR::Linkage::External)));
+    auto main = unit.getOrInsertFunction("main", fnTyMain, IR::Linkage::External);
 
     IR::Builder builder(ctx);
     auto entry = main->insertBlock("entry");
@@ -1,6 +1,7 @@
 #include "cases.hpp"
 #include "context.hpp"
 #include "opt_level.hpp"
+#include "IR/parser.hpp"
 
 #include <filesystem>
 #include <fstream>
@@ -15,6 +16,12 @@ Unit createUnit(const std::string& name) {
     return Unit(name, ctx);
 }
 
+std::unique_ptr<Unit> parseUnit(const std::string& source) {
+    auto ctx = std::make_shared<Context>();
+    ctx->registerAllTargets();
+    return IR::Parser(source, ctx).parse();
+}
+
 std::string archString(Target::Arch arch) {
     switch(arch) {
         case scbe::Target::Arch::x86_64: return "x86_64";
@@ -24,7 +31,26 @@ std::string archString(Target::Arch arch) {
     return "unknown";
 }
 
-std::optional<std::string> compileUnit(Unit& unit, Target::TargetSpecification spec, int debug) {
+std::string compileObject(Unit& unit, Target::TargetSpecification spec, int debug, Ref<Codegen::CompilationCache> cache, Codegen::ObjectFileOptions options) {
+    std::filesystem::create_directories(BUILD_FOLDER);
+
+    Ref<Target::Target> target = unit.getContext()->getTargetRegistry().getTarget(spec);
+
+    auto machine = target->getTargetMachine(spec, unit.getContext());
+    unit.setDataLayout(machine->getDataLayout());
+    if(cache) machine->setCompilationCache(cache);
+    machine->setObjectFileOptions(options);
+
+    std::string path = BUILD_FOLDER + unit.getName() + "_" + archString(spec.getArch()) + "_" + std::to_string(debug) + ".o";
+    std::ofstream objOut(path, std::ios::binary);
+    auto passManager = std::make_shared<PassManager>();
+    machine->addPassesForCodeGeneration(passManager, objOut, Target::FileType::ObjectFile, (scbe::OptimizationLevel)debug);
+    passManager->run(unit);
+    objOut.close();
+    return path;
+}
+
+std::optional<std::string> compileUnit(Unit& unit, Target::TargetSpecification spec, int debug, Ref<Codegen::CompilationCache> cache) {
     std::filesystem::create_directories(BUILD_FOLDER);
     
     Ref<Target::Target> target = unit.getContext()->getTargetRegistry().getTarget(spec);
@@ -36,14 +62,7 @@ std::optional<std::string> compileUnit(Unit& unit, Target::TargetSpecification s
     std::string prefix = BUILD_FOLDER + filePrefix;
 
     if(spec.getArch() == Target::Arch::x86_64) {
-        std::ofstream objOut(prefix + ".o");
-        auto passManager = std::make_shared<PassManager>();
-        machine->addPassesForCodeGeneration(passManager, objOut, Target::FileType::ObjectFile, (scbe::OptimizationLevel)debug);
-        passManager->run(unit);
-        objOut.close();
-
-        std::string lkCmd = "gcc -m64 " + prefix + ".o -o " + prefix + ".out";
-        if(std::system(lkCmd.c_str()) != 0) return std::nullopt;
+        return linkObject(compileObject(unit, spec, debug, cache), spec);
     }
     else if(spec.getArch() == Target::Arch::AArch64) {
         auto passManager = std::make_shared<PassManager>();
@@ -55,11 +74,22 @@ std::optional<std::string> compileUnit(Unit& unit, Target::TargetSpecification s
         std::string asCmd = "aarch64-linux-gnu-as " + prefix + ".s -o " + prefix + ".o";
         if(std::system(asCmd.c_str()) != 0) return std::nullopt;
 
-        std::string lkCmd = "aarch64-linux-gnu-gcc -static " + prefix + ".o -o " + prefix + ".out";
-        if(std::system(lkCmd.c_str()) != 0) return std::nullopt;
+        return linkObject(prefix + ".o", spec);
     }
 
-    return prefix + ".out";
+    return std::nullopt;
+}
+
+std::optional<std::string> linkObject(const std::string& object, Target::TargetSpecification spec) {
+    std::string program = std::filesystem::path(object).replace_extension(".out").string();
+    std::string lkCmd;
+    switch(spec.getArch()) {
+        case scbe::Target::Arch::x86_64: lkCmd = "gcc -m64 " + object + " -o " + program; break;
+        case scbe::Target::Arch::AArch64: lkCmd = "aarch64-linux-gnu-gcc -static " + object + " -o " + program; break;
+        default: return std::nullopt;
+    }
+    if(std::system(lkCmd.c_str()) != 0) return std::nullopt;
+    return program;
 }
 
 uint8_t executeProgram(std::string program, Target::Arch arch, std::vector<std::string> args) {
@@ -85,4 +115,11 @@ uint8_t executeProgram(std::string program, Target::Arch arch, std::vector<std::
 #else
     return result;
 #endif
+}
+
+bool expectSource(const std::string& source, Target::TargetSpecification& spec, int debug, uint8_t expected) {
+    auto unit = parseUnit(source);
+    auto program = compileUnit(*unit, spec, debug);
+    if(!program) return false;
+    return expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), expected);
 }
\ No newline at end of file
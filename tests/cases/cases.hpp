@@ -4,15 +4,25 @@
 #include "IR/function.hpp"
 #include "IR/global_value.hpp"
 #include "target/target_specification.hpp"
+#include "codegen/compilation_cache.hpp"
+#include "codegen/object_file_options.hpp"
 
 #include <optional>
 #include <stdexcept>
 
 scbe::Unit createUnit(const std::string& name);
 
+// parses a unit in the textual IR format
+std::unique_ptr<scbe::Unit> parseUnit(const std::string& source);
+
 std::string archString(scbe::Target::Arch arch);
 
-std::optional<std::string> compileUnit(scbe::Unit& unit, scbe::Target::TargetSpecification spec, int debug);
+// emits an object file without linking it, returns its path
+std::string compileObject(scbe::Unit& unit, scbe::Target::TargetSpecification spec, int debug, scbe::Ref<scbe::Codegen::CompilationCache> cache = nullptr, scbe::Codegen::ObjectFileOptions options = {});
+
+std::optional<std::string> compileUnit(scbe::Unit& unit, scbe::Target::TargetSpecification spec, int debug, scbe::Ref<scbe::Codegen::CompilationCache> cache = nullptr);
+
+std::optional<std::string> linkObject(const std::string& object, scbe::Target::TargetSpecification spec);
 
 uint8_t executeProgram(std::string program, scbe::Target::Arch arch, std::vector<std::string> args = {});
 
@@ -23,6 +33,9 @@ inline bool expectInteger(T actual, T expected) {
     return true;
 }
 
+// compiles and runs the IR, checking the exit code of main
+bool expectSource(const std::string& source, scbe::Target::TargetSpecification& spec, int debug, uint8_t expected);
+
 
 bool case0(scbe::Target::TargetSpecification& spec, int debug);
 bool case1(scbe::Target::TargetSpecification& spec, int debug);
@@ -0,0 +1,99 @@
+#include "cases/cases.hpp"
+#include "context.hpp"
+#include "IR/block.hpp"
+#include "IR/builder.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <filesystem>
+#include <fstream>
+
+using namespace scbe;
+
+static void buildCacheUnit(Unit& unit, int constant) {
+    auto ctx = unit.getContext();
+    auto i32 = ctx->getI32Type();
+    auto unaryTy = ctx->makeFunctionType({i32}, i32);
+    IR::Builder builder(ctx);
+
+    auto square = unit.getOrInsertFunction("square", unaryTy, IR::Linkage::External);
+    builder.setCurrentBlock(square->insertBlock("entry"));
+    auto x = square->getArguments().at(0).get();
+    builder.createRet(builder.createIMul(x, x));
+
+    auto offset = unit.getOrInsertFunction("offset", unaryTy, IR::Linkage::External);
+    builder.setCurrentBlock(offset->insertBlock("entry"));
+    builder.createRet(builder.createAdd(offset->getArguments().at(0).get(), IR::ConstantInt::get(32, constant, ctx)));
+
+    auto main = unit.getOrInsertFunction("main", ctx->makeFunctionType({}, i32), IR::Linkage::External);
+    builder.setCurrentBlock(main->insertBlock("entry"));
+    auto a = builder.createCall(square, {IR::ConstantInt::get(32, 6, ctx)});
+    builder.createRet(builder.createCall(offset, {a}));
+}
+
+TEST_CASE("Compilation cache") {
+    auto debug = GENERATE(0, 1, 2);
+    CAPTURE(debug);
+
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    auto cache = std::make_shared<Codegen::CompilationCache>();
+
+    Unit first = createUnit("cache");
+    buildCacheUnit(first, 4);
+    auto program = compileUnit(first, spec, debug, cache);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 40));
+    REQUIRE(cache->getHits() == 0);
+    REQUIRE(cache->getMisses() == 3);
+
+    // an identical unit is spliced together from the cache
+    cache->resetStatistics();
+    Unit second = createUnit("cache");
+    buildCacheUnit(second, 4);
+    program = compileUnit(second, spec, debug, cache);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 40));
+    REQUIRE(cache->getHits() == 3);
+    REQUIRE(cache->getMisses() == 0);
+
+    // only the changed function is compiled again, with optimizations main is too since it could inline it
+    cache->resetStatistics();
+    Unit third = createUnit("cache");
+    buildCacheUnit(third, 5);
+    program = compileUnit(third, spec, debug, cache);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 41));
+    REQUIRE(cache->getMisses() == (debug == 0 ? 1 : 2));
+}
+
+TEST_CASE("Compilation cache on disk") {
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    std::string directory = "cache_x86_64";
+    std::filesystem::remove_all(directory);
+
+    Unit first = createUnit("cache");
+    buildCacheUnit(first, 4);
+    auto firstCache = std::make_shared<Codegen::CompilationCache>(directory);
+    auto object = compileObject(first, spec, 1, firstCache);
+    REQUIRE(firstCache->getMisses() == 3);
+
+    std::ifstream firstFile(object, std::ios::binary);
+    std::string firstBytes((std::istreambuf_iterator<char>(firstFile)), std::istreambuf_iterator<char>());
+    firstFile.close();
+
+    // a fresh cache finds the entries persisted by the first one and produces the same object
+    Unit second = createUnit("cache");
+    buildCacheUnit(second, 4);
+    auto secondCache = std::make_shared<Codegen::CompilationCache>(directory);
+    object = compileObject(second, spec, 1, secondCache);
+    REQUIRE(secondCache->getHits() == 3);
+    REQUIRE(secondCache->getMisses() == 0);
+
+    std::ifstream secondFile(object, std::ios::binary);
+    std::string secondBytes((std::istreambuf_iterator<char>(secondFile)), std::istreambuf_iterator<char>());
+    secondFile.close();
+    REQUIRE(firstBytes == secondBytes);
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(object);
+}
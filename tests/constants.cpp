@@ -0,0 +1,160 @@
+#include "cases/cases.hpp"
+#include "IR/folder.hpp"
+#include "IR/printer.hpp"
+#include "context.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <elfio/elfio.hpp>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+using namespace scbe;
+using namespace ELFIO;
+
+static constexpr size_t s_tableSize = 4096;
+
+static int32_t tableElement(size_t index) {
+    return (int32_t)index * 3 - 1000;
+}
+
+static std::string packedSource() {
+    std::string table;
+    for(size_t i = 0; i < s_tableSize; i++)
+        table += (i ? ", i32 " : "i32 ") + std::to_string(tableElement(i));
+
+    std::string size = std::to_string(s_tableSize);
+    return R"(Unit packed
+global table constant i32[)" + size + "]* = i32[" + size + "] { " + table + R"( }
+global small constant i16[4]* = i16[4] { i16 -1, i16 2, i16 -3, i16 4 }
+global zeros i32[256]* = i32[256] zeroinitializer
+fn main() -> i32 {
+entry:
+    %t = getelementptr i32[)" + size + "]* @table, i64 0, i64 1000" + R"(
+    %tv = load i32* %t
+    %s = getelementptr i16[4]* @small, i64 0, i64 2
+    %sl = load i16* %s
+    %sv = i32 sext i16 %sl
+    %z = getelementptr i32[256]* @zeros, i64 0, i64 7
+    %before = load i32* %z
+    store i32* %z, i32 4
+    %after = load i32* %z
+    %a = add i32 %tv, i32 %sv
+    %b = add i32 %a, i32 %before
+    %r = add i32 %b, i32 %after
+    ret i32 %r
+}
+)";
+}
+
+TEST_CASE("Packed constant arrays") {
+    auto ctx = std::make_shared<Context>();
+    ArrayType* shorts = ctx->makeArrayType(ctx->getI16Type(), 3);
+    std::vector<IR::Constant*> values = {ctx->getConstantInt(16, -2), ctx->getConstantInt(16, 300), ctx->getConstantInt(16, 7)};
+    IR::ConstantDataArray* packed = IR::ConstantDataArray::get(shorts, values, ctx);
+    REQUIRE(packed->getData() == std::vector<uint8_t>{0xFE, 0xFF, 0x2C, 0x01, 0x07, 0x00});
+    REQUIRE(packed->getElementSize() == 2);
+    REQUIRE(packed->getElementAsInt(0) == -2);
+    REQUIRE(packed->getElementAsInt(1) == 300);
+    REQUIRE(packed->getElementAsConstant(2, ctx) == ctx->getConstantInt(16, 7));
+    REQUIRE(IR::ConstantDataArray::get(shorts, std::vector<uint8_t>{0xFE, 0xFF, 0x2C, 0x01, 0x07, 0x00}, ctx)->getElementAsInt(1) == 300);
+
+    IR::ConstantDataArray* string = IR::ConstantDataArray::fromString("abc", ctx);
+    REQUIRE(string->isString());
+    REQUIRE(string->getNumElements() == 4);
+    REQUIRE(string->getAsString() == std::string("abc", 4));
+    REQUIRE(!IR::ConstantDataArray::get(ctx->makeArrayType(ctx->getI8Type(), 3), std::vector<uint8_t>{'a', 0, 0}, ctx)->isString());
+
+    ArrayType* floats = ctx->makeArrayType(ctx->getF64Type(), 2);
+    IR::ConstantDataArray* doubles = IR::ConstantDataArray::get(floats, std::vector<IR::Constant*>{ctx->getConstantFloat(64, 1.5), ctx->getConstantFloat(64, -0.25)}, ctx);
+    REQUIRE(doubles->getData().size() == 16);
+    REQUIRE(doubles->getElementAsFloat(1) == -0.25);
+
+    IR::ConstantAggregateZero* zero = IR::ConstantAggregateZero::get(floats, ctx);
+    REQUIRE(IR::ConstantAggregateZero::get(floats, ctx) == zero);
+    REQUIRE(zero->getElement(1, nullptr, ctx) == ctx->getConstantFloat(64, 0));
+}
+
+TEST_CASE("Packed constants in units") {
+    auto unit = parseUnit(packedSource());
+    auto& globals = unit->getGlobals();
+    REQUIRE(globals.size() == 3);
+    IR::GlobalVariable* table = globals.at(0).get();
+    // a large initializer is one constant holding raw bytes, not an element per value
+    REQUIRE(table->getValue()->isConstantDataArray());
+    auto data = cast<IR::ConstantDataArray>(table->getValue());
+    REQUIRE(data->getData().size() == s_tableSize * 4);
+    REQUIRE(data->getElementAsInt(1000) == tableElement(1000));
+    REQUIRE(globals.at(2)->getValue()->isConstantAggregateZero());
+
+    std::stringstream printed;
+    IR::HumanPrinter(printed).print(*unit);
+    std::stringstream reprinted;
+    IR::HumanPrinter(reprinted).print(*parseUnit(printed.str()));
+    REQUIRE(reprinted.str() == printed.str());
+
+    // loads out of read only data fold to the element
+    Ref<Context> ctx = unit->getContext();
+    IR::Folder folder(ctx);
+    auto element = IR::ConstantGEP::get(table, {ctx->getConstantInt(64, 0), ctx->getConstantInt(64, 17)}, ctx);
+    REQUIRE(folder.foldLoad(element) == ctx->getConstantInt(32, tableElement(17)));
+    auto outside = IR::ConstantGEP::get(table, {ctx->getConstantInt(64, 0), ctx->getConstantInt(64, s_tableSize)}, ctx);
+    REQUIRE(folder.foldLoad(outside) == nullptr);
+    auto zero = IR::ConstantGEP::get(globals.at(2).get(), {ctx->getConstantInt(64, 0), ctx->getConstantInt(64, 3)}, ctx);
+    // zeros isn't read only, a store could change it
+    REQUIRE(folder.foldLoad(zero) == nullptr);
+}
+
+TEST_CASE("Packed constants in objects") {
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    auto object = compileObject(*parseUnit(packedSource()), spec, 0);
+
+    elfio reader;
+    REQUIRE(reader.load(object));
+    std::vector<uint8_t> expected(s_tableSize * 4);
+    for(size_t i = 0; i < s_tableSize; i++) {
+        int32_t value = tableElement(i);
+        std::memcpy(expected.data() + i * 4, &value, 4);
+    }
+
+    bool foundTable = false, foundZeros = false;
+    for(auto& sec : reader.sections) {
+        if(sec->get_type() != SHT_SYMTAB) continue;
+        symbol_section_accessor symbols(reader, sec.get());
+        for(Elf_Xword i = 0; i < symbols.get_symbols_num(); i++) {
+            std::string name;
+            Elf64_Addr value;
+            Elf_Xword size;
+            unsigned char bind, type, other;
+            Elf_Half index;
+            symbols.get_symbol(i, name, value, size, bind, type, index, other);
+            if(name == "table") {
+                section* rodata = reader.sections[index];
+                REQUIRE(rodata->get_name() == ".rodata");
+                REQUIRE(size == expected.size());
+                REQUIRE(value + size <= rodata->get_size());
+                REQUIRE(std::memcmp(rodata->get_data() + value, expected.data(), expected.size()) == 0);
+                foundTable = true;
+            }
+            else if(name == "zeros") {
+                REQUIRE(reader.sections[index]->get_name() == ".bss");
+                REQUIRE(size == 256 * 4);
+                foundZeros = true;
+            }
+        }
+    }
+    REQUIRE(foundTable);
+    REQUIRE(foundZeros);
+    std::filesystem::remove(object);
+}
+
+TEST_CASE("Packed constant programs") {
+    auto target = GENERATE("x86_64", "aarch64");
+    auto debug = GENERATE(0, 1, 2);
+    CAPTURE(target, debug);
+
+    Target::TargetSpecification spec(std::string(target) + "-pc-linux-gnu");
+    // 2000 - 3 + 0 + 4
+    REQUIRE(expectSource(packedSource(), spec, debug, (uint8_t)2001));
+}
@@ -0,0 +1,307 @@
+#include "cases/cases.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <elfio/elfio.hpp>
+#include <filesystem>
+
+using namespace scbe;
+using namespace ELFIO;
+
+struct ElfSymbol {
+    std::string m_name;
+    Elf64_Addr m_value = 0;
+    Elf_Xword m_size = 0;
+    unsigned char m_bind = 0;
+    unsigned char m_type = 0;
+    Elf_Half m_section = 0;
+};
+
+static std::vector<ElfSymbol> getSymbols(elfio& reader) {
+    std::vector<ElfSymbol> symbols;
+    for(auto& sec : reader.sections) {
+        if(sec->get_type() != SHT_SYMTAB) continue;
+        symbol_section_accessor accessor(reader, sec.get());
+        for(Elf_Xword i = 0; i < accessor.get_symbols_num(); i++) {
+            ElfSymbol symbol;
+            unsigned char other;
+            accessor.get_symbol(i, symbol.m_name, symbol.m_value, symbol.m_size, symbol.m_bind, symbol.m_type, symbol.m_section, other);
+            symbols.push_back(symbol);
+        }
+    }
+    return symbols;
+}
+
+static const ElfSymbol* findSymbol(const std::vector<ElfSymbol>& symbols, const std::string& name) {
+    for(auto& symbol : symbols)
+        if(symbol.m_name == name) return &symbol;
+    return nullptr;
+}
+
+static section* findSection(elfio& reader, const std::string& name) {
+    for(auto& sec : reader.sections)
+        if(sec->get_name() == name) return sec.get();
+    return nullptr;
+}
+
+static size_t countSections(elfio& reader, Elf_Word type) {
+    size_t count = 0;
+    for(auto& sec : reader.sections)
+        if(sec->get_type() == type) count++;
+    return count;
+}
+
+static const char* s_sections = R"(Unit sections
+global counter i32* = i32 3
+global limit i32* = i32 4
+internal fn twice(i32 %x) -> i32 {
+entry:
+    %r = add i32 %x, i32 %x
+    ret i32 %r
+}
+fn helper(i32 %x) -> i32 {
+entry:
+    %c = load i32* @counter
+    %t = call i32(i32) twice(i32 %x)
+    %r = add i32 %t, i32 %c
+    ret i32 %r
+}
+fn main() -> i32 {
+entry:
+    %l = load i32* @limit
+    %r = call i32(i32) helper(i32 %l)
+    ret i32 %r
+}
+)";
+
+TEST_CASE("Function and data sections") {
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    auto unit = parseUnit(s_sections);
+    Codegen::ObjectFileOptions options;
+    options.m_functionSections = true;
+    options.m_dataSections = true;
+    auto object = compileObject(*unit, spec, 0, nullptr, options);
+
+    elfio reader;
+    REQUIRE(reader.load(object));
+    auto symbols = getSymbols(reader);
+    for(std::string name : {"twice", "helper", "main"}) {
+        CAPTURE(name);
+        section* text = findSection(reader, ".text." + name);
+        REQUIRE(text);
+        REQUIRE(text->get_flags() == (SHF_ALLOC | SHF_EXECINSTR));
+        const ElfSymbol* symbol = findSymbol(symbols, name);
+        REQUIRE(symbol);
+        REQUIRE(symbol->m_section == text->get_index());
+        REQUIRE(symbol->m_value == 0);
+        REQUIRE(symbol->m_size == text->get_size());
+    }
+    REQUIRE(!findSection(reader, ".text"));
+    // calls between sections are left to the linker
+    REQUIRE(findSection(reader, ".rela.text.main"));
+    REQUIRE(findSection(reader, ".rela.text.helper"));
+
+    for(std::string name : {"counter", "limit"}) {
+        CAPTURE(name);
+        section* data = findSection(reader, ".data." + name);
+        REQUIRE(data);
+        REQUIRE(findSymbol(symbols, name)->m_section == data->get_index());
+    }
+    REQUIRE(countSections(reader, SHT_GROUP) == 0);
+
+    auto program = linkObject(object, spec);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 11));
+}
+
+TEST_CASE("COMDAT groups") {
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    auto unit = parseUnit(s_sections);
+    Codegen::ObjectFileOptions options;
+    options.m_comdat = true;
+    auto object = compileObject(*unit, spec, 0, nullptr, options);
+
+    elfio reader;
+    REQUIRE(reader.load(object));
+    auto symbols = getSymbols(reader);
+
+    // one group per external function, keyed by its symbol, internal functions are left out
+    REQUIRE(countSections(reader, SHT_GROUP) == 2);
+    for(auto& sec : reader.sections) {
+        if(sec->get_type() != SHT_GROUP) continue;
+        const ElfSymbol& signature = symbols.at(sec->get_info());
+        CAPTURE(signature.m_name);
+        REQUIRE((signature.m_name == "helper" || signature.m_name == "main"));
+
+        const Elf_Word* words = (const Elf_Word*)sec->get_data();
+        REQUIRE(sec->get_size() >= 8);
+        REQUIRE(words[0] == GRP_COMDAT);
+        section* text = findSection(reader, ".text." + signature.m_name);
+        REQUIRE(text);
+        REQUIRE(words[1] == text->get_index());
+        REQUIRE((text->get_flags() & SHF_GROUP));
+    }
+    REQUIRE(!(findSection(reader, ".text.twice")->get_flags() & SHF_GROUP));
+
+    auto program = linkObject(object, spec);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 11));
+}
+
+static const char* s_placement = R"(Unit placement
+global zeros i64[4]* = i64[4] { i64 0, i64 0, i64 0, i64 0 }
+global count i32* = i32 0
+global state i32* = i32 7
+global table constant i32[4]* = i32[4] { i32 1, i32 2, i32 3, i32 4 }
+global message constant i8[6]* = i8[6] "hello\0"
+global inner constant i8[4]* = i8[4] "a\0b\0"
+global pointer constant i32** = i32* @state
+fn main() -> i32 {
+entry:
+    %z = getelementptr i64[4]* @zeros, i64 0, i64 3
+    store i64* %z, i64 5
+    store i32* @count, i32 2
+    %zl = load i64* %z
+    %zv = i32 trunc i64 %zl
+    %c = load i32* @count
+    %t = getelementptr i32[4]* @table, i64 0, i64 2
+    %tv = load i32* %t
+    %m = getelementptr i8[6]* @message, i64 0, i64 1
+    %mc = load i8* %m
+    %mv = i32 zext i8 %mc
+    %i = getelementptr i8[4]* @inner, i64 0, i64 2
+    %ic = load i8* %i
+    %iv = i32 zext i8 %ic
+    %p = load i32** @pointer
+    %pv = load i32* %p
+    %a = add i32 %zv, i32 %c
+    %b = add i32 %a, i32 %tv
+    %d = add i32 %b, i32 %mv
+    %e = add i32 %d, i32 %iv
+    %r = add i32 %e, i32 %pv
+    ret i32 %r
+}
+)";
+
+TEST_CASE("Data placement") {
+    auto target = GENERATE("x86_64", "aarch64");
+    CAPTURE(target);
+
+    Target::TargetSpecification spec(std::string(target) + "-pc-linux-gnu");
+    // AArch64 goes through the assembler
+    if(spec.getArch() == Target::Arch::x86_64) {
+        auto unit = parseUnit(s_placement);
+        auto object = compileObject(*unit, spec, 0);
+
+        elfio reader;
+        REQUIRE(reader.load(object));
+        auto symbols = getSymbols(reader);
+        auto placedIn = [&](const std::string& name) -> std::string {
+            const ElfSymbol* symbol = findSymbol(symbols, name);
+            if(!symbol || symbol->m_section >= reader.sections.size()) return "";
+            return reader.sections[symbol->m_section]->get_name();
+        };
+
+        REQUIRE(placedIn("zeros") == ".bss");
+        REQUIRE(placedIn("count") == ".bss");
+        REQUIRE(placedIn("state") == ".data");
+        REQUIRE(placedIn("table") == ".rodata");
+        REQUIRE(placedIn("message") == ".rodata.str1.1");
+        // an inner null would split the string when merged
+        REQUIRE(placedIn("inner") == ".rodata");
+        REQUIRE(placedIn("pointer") == ".data.rel.ro");
+
+        section* bss = findSection(reader, ".bss");
+        REQUIRE(bss->get_type() == SHT_NOBITS);
+        REQUIRE(bss->get_flags() == (SHF_ALLOC | SHF_WRITE));
+        REQUIRE(bss->get_size() >= 4 * 8 + 4);
+        REQUIRE(findSection(reader, ".rodata")->get_flags() == SHF_ALLOC);
+        section* strings = findSection(reader, ".rodata.str1.1");
+        REQUIRE(strings->get_flags() == (SHF_ALLOC | SHF_MERGE | SHF_STRINGS));
+        REQUIRE(strings->get_entry_size() == 1);
+        REQUIRE(findSymbol(symbols, "message")->m_size == 6);
+        std::filesystem::remove(object);
+    }
+
+    auto program = compileUnit(*parseUnit(s_placement), spec, 0);
+    REQUIRE(program);
+    // 5 + 2 + 3 + 'e' + 'b' + 7
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), (uint8_t)(5 + 2 + 3 + 'e' + 'b' + 7)));
+}
+
+static const char* s_symbols = R"(Unit symbols
+global values i32[4]* = i32[4] { i32 4, i32 3, i32 2, i32 1 }
+global scale i64* = i64 2
+internal fn sum(i32* %values, i32 %count) -> i32 {
+entry:
+    jump loophead
+loophead:
+    %i = phi i32 0, entry, i32 %next, loopbody
+    %total = phi i32 0, entry, i32 %added, loopbody
+    %more = icmp lt i32 %i, i32 %count
+    jump loopbody, loopdone, i1 %more
+loopbody:
+    %p = getelementptr i32* %values, i32 %i
+    %v = load i32* %p
+    %added = add i32 %total, i32 %v
+    %next = add i32 %i, i32 1
+    jump loophead
+loopdone:
+    ret i32 %total
+}
+fn main() -> i32 {
+entry:
+    %first = getelementptr i32[4]* @values, i64 0, i64 0
+    %s = call i32(i32*, i32) sum(i32* %first, i32 4)
+    %l = load i64* @scale
+    %t = i32 trunc i64 %l
+    %r = imul i32 %s, i32 %t
+    ret i32 %r
+}
+)";
+
+TEST_CASE("Symbol tables") {
+    Target::TargetSpecification spec("x86_64-pc-linux-gnu");
+    auto object = compileObject(*parseUnit(s_symbols), spec, 0);
+
+    elfio reader;
+    REQUIRE(reader.load(object));
+    auto symbols = getSymbols(reader);
+    // blocks are resolved inside the object, nothing is exported for them
+    for(auto& symbol : symbols) {
+        CAPTURE(symbol.m_name);
+        REQUIRE(symbol.m_name.find("loop") == std::string::npos);
+        if(symbol.m_type == STT_SECTION) REQUIRE(symbol.m_bind == STB_LOCAL);
+    }
+    section* strings = findSection(reader, ".strtab");
+    REQUIRE(strings);
+    REQUIRE(std::string(strings->get_data(), strings->get_size()).find("loop") == std::string::npos);
+
+    section* text = findSection(reader, ".text");
+    REQUIRE(text);
+    const ElfSymbol* sum = findSymbol(symbols, "sum");
+    const ElfSymbol* main = findSymbol(symbols, "main");
+    REQUIRE(sum);
+    REQUIRE(main);
+    REQUIRE(sum->m_type == STT_FUNC);
+    REQUIRE(sum->m_bind == STB_LOCAL);
+    REQUIRE(main->m_type == STT_FUNC);
+    REQUIRE(main->m_bind == STB_GLOBAL);
+    // functions are laid out back to back and each symbol spans its whole body
+    REQUIRE(sum->m_size > 0);
+    REQUIRE(main->m_size > 0);
+    REQUIRE(sum->m_size + main->m_size <= text->get_size());
+    const ElfSymbol* first = sum->m_value < main->m_value ? sum : main;
+    const ElfSymbol* second = first == sum ? main : sum;
+    REQUIRE(first->m_value + first->m_size <= second->m_value);
+
+    const ElfSymbol* values = findSymbol(symbols, "values");
+    REQUIRE(values);
+    REQUIRE(values->m_type == STT_OBJECT);
+    REQUIRE(values->m_size == 16);
+    REQUIRE(findSymbol(symbols, "scale")->m_size == 8);
+
+    auto program = linkObject(object, spec);
+    REQUIRE(program);
+    REQUIRE(expectInteger<uint8_t>(executeProgram(program.value(), spec.getArch()), 20));
+}
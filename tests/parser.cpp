@@ -0,0 +1,106 @@
+#include "cases/cases.hpp"
+#include "IR/parser.hpp"
+#include "IR/printer.hpp"
+#include "context.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <sstream>
+
+using namespace scbe;
+
+static const char* s_source = R"(Unit parser
+Node { i64, Node* };
+global head Node* = Node { i64 5, Node* null }
+global counts i32[3]* = i32[3] { i32 1, i32 2, i32 3 }
+global name constant i8[3]* = i8[3] "ok\0"
+extern fn abs(i32 %x) -> i32;
+internal fn negate(i32 %x) -> i32 {
+entry:
+    %r = sub i32 0, i32 %x
+    ret i32 %r
+}
+internal fn sum(i32* %values, i32 %count) -> i32 {
+entry:
+    jump head
+head:
+    %i = phi i32 0, entry, i32 %next, body
+    %total = phi i32 0, entry, i32 %added, body
+    %more = icmp lt i32 %i, i32 %count
+    jump body, done, i1 %more
+body:
+    %p = getelementptr i32* %values, i32 %i
+    %v = load i32* %p
+    %added = add i32 %total, i32 %v
+    %next = add i32 %i, i32 1
+    jump head
+done:
+    ret i32 %total
+}
+fn main() -> i32 {
+entry:
+    %first = getelementptr i32[3]* @counts, i64 0, i64 0
+    %s = call i32(i32*, i32) sum(i32* %first, i32 3)
+    %n = call i32(i32) negate(i32 -10)
+    %p = getelementptr Node* @head, i32 0, i32 0
+    %v = load i64* %p
+    %t = i32 trunc i64 %v
+    %a = add i32 %s, i32 %n
+    %r = add i32 %a, i32 %t
+    ret i32 %r
+}
+)";
+
+static std::string printUnit(Unit& unit) {
+    std::stringstream stream;
+    IR::HumanPrinter(stream).print(unit);
+    return stream.str();
+}
+
+static std::string parseError(const std::string& source) {
+    try {
+        parseUnit(source);
+    }
+    catch(const std::runtime_error& error) {
+        return error.what();
+    }
+    return "";
+}
+
+TEST_CASE("Parser round trip") {
+    auto unit = parseUnit(s_source);
+    REQUIRE(unit->getName() == "parser");
+
+    // what the printer writes parses back to the same thing
+    std::string printed = printUnit(*unit);
+    auto reparsed = parseUnit(printed);
+    REQUIRE(printUnit(*reparsed) == printed);
+}
+
+TEST_CASE("Parser programs") {
+    auto target = GENERATE("x86_64", "aarch64");
+    auto debug = GENERATE(0, 1, 2);
+    CAPTURE(target, debug);
+
+    Target::TargetSpecification spec(std::string(target) + "-pc-linux-gnu");
+    // 1 + 2 + 3 + 10 + 5
+    REQUIRE(expectSource(s_source, spec, debug, 21));
+}
+
+TEST_CASE("Parser errors") {
+    REQUIRE(parseError("fn main() -> i32 {}").starts_with("<input>:1:1: expected 'Unit'"));
+    REQUIRE(parseError("Unit e\nfn main() -> i32 {\nentry:\n    %a = frobnicate i32 1, i32 2\n    ret i32 %a\n}\n").starts_with("<input>:4:10: expected instruction"));
+    REQUIRE(parseError("Unit e\nfn main() -> i32 {\nentry:\n    ret i32 %missing\n}\n").starts_with("<input>:4:"));
+    REQUIRE(parseError("Unit e\nfn main() -> i32 {\nentry:\n    jump nowhere\n}\n").starts_with("<input>:4:"));
+    REQUIRE(parseError("Unit e\nfn main() -> i32 {\nentry:\n    %p = load i32* @missing\n    ret i32 %p\n}\n").starts_with("<input>:4:"));
+    REQUIRE(parseError("Unit e\nfn main() -> i32 {\nentry:\n    ret i32 0\n").size() > 0);
+
+    IR::Parser parser("Unit e\nfn f( -> i32;\n", std::make_shared<Context>(), "named.ir");
+    REQUIRE_THROWS_AS(parser.parse(), std::runtime_error);
+    try {
+        IR::Parser("Unit e\nfn f( -> i32;\n", std::make_shared<Context>(), "named.ir").parse();
+    }
+    catch(const std::runtime_error& error) {
+        REQUIRE(std::string(error.what()).starts_with("named.ir:2:"));
+    }
+}
@@ -9,7 +9,7 @@ using namespace scbe;
 
 TEST_CASE("Tests") {
     auto target = GENERATE("x86_64", "aarch64");
-    auto debug = GENERATE(0, 1);
+    auto debug = GENERATE(0, 1, 2);
     CAPTURE(target, debug);
 
     Target::TargetSpecification spec(std::string(target) + "-pc-linux-gnu");
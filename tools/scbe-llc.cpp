@@ -0,0 +1,186 @@
+#include "IR/bitcode_format.hpp"
+#include "IR/bitcode_reader.hpp"
+#include "IR/function.hpp"
+#include "IR/parser.hpp"
+#include "IR/printer.hpp"
+#include "MIR/printer.hpp"
+#include "context.hpp"
+#include "opt_level.hpp"
+#include "pass_manager.hpp"
+#include "target/target.hpp"
+#include "target/target_machine.hpp"
+#include "unit.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace scbe;
+
+static void printUsage() {
+    std::cerr <<
+        "usage: scbe-llc <input> [options]\n"
+        "\n"
+        "Compiles a textual (or binary) scbe IR file.\n"
+        "\n"
+        "options:\n"
+        "  -o <file>                 output file, defaults to the input name with .s or .o\n"
+        "  -mtriple=<triple>         target triple, defaults to x86_64-pc-linux-gnu\n"
+        "  -O0, -O1, -O2             optimization level, defaults to -O0\n"
+        "  -filetype=asm|obj         output type, defaults to asm\n"
+        "  -function-sections        emit every function in its own .text.<name> section (ELF only)\n"
+        "  -data-sections            emit every global in its own .data.<name> section (ELF only)\n"
+        "  -comdat                   put external functions in COMDAT groups, implies -function-sections\n"
+        "  -time-passes              print the time spent in each pass\n"
+        "  -print-after=<p1,p2,...>  dump IR (or MIR once selected) after the named passes\n"
+        "  -print-after-all          dump IR (or MIR once selected) after every pass\n"
+        "  -print-passes             list the names of the passes that ran\n";
+}
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> result;
+    std::stringstream stream(list);
+    std::string item;
+    while(std::getline(stream, item, ','))
+        if(!item.empty()) result.push_back(item);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::string input;
+    std::string output;
+    std::string triple = "x86_64-pc-linux-gnu";
+    OptimizationLevel level = OptimizationLevel::O0;
+    Target::FileType fileType = Target::FileType::AssemblyFile;
+    bool timePasses = false;
+    bool printAfterAll = false;
+    bool printPasses = false;
+    Codegen::ObjectFileOptions objectOptions;
+    std::vector<std::string> printAfter;
+
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        }
+        else if(arg == "-o" && i + 1 < argc) output = argv[++i];
+        else if(arg.starts_with("-mtriple=")) triple = arg.substr(9);
+        else if(arg == "-O0") level = OptimizationLevel::O0;
+        else if(arg == "-O1") level = OptimizationLevel::O1;
+        else if(arg == "-O2") level = OptimizationLevel::O2;
+        else if(arg == "-filetype=asm") fileType = Target::FileType::AssemblyFile;
+        else if(arg == "-filetype=obj") fileType = Target::FileType::ObjectFile;
+        else if(arg == "-function-sections") objectOptions.m_functionSections = true;
+        else if(arg == "-data-sections") objectOptions.m_dataSections = true;
+        else if(arg == "-comdat") objectOptions.m_comdat = true;
+        else if(arg == "-time-passes") timePasses = true;
+        else if(arg == "-print-after-all") printAfterAll = true;
+        else if(arg == "-print-passes") printPasses = true;
+        else if(arg.starts_with("-print-after=")) {
+            for(auto& pass : split(arg.substr(13))) printAfter.push_back(pass);
+        }
+        else if(!arg.starts_with("-") && input.empty()) input = arg;
+        else {
+            std::cerr << "scbe-llc: unknown argument " << arg << "\n";
+            printUsage();
+            return 1;
+        }
+    }
+
+    if(input.empty()) {
+        printUsage();
+        return 1;
+    }
+    if(output.empty())
+        output = std::filesystem::path(input).replace_extension(fileType == Target::FileType::AssemblyFile ? ".s" : ".o").string();
+
+    auto context = std::make_shared<Context>();
+    context->registerAllTargets();
+    Target::TargetSpecification spec(triple);
+    if(spec.getArch() == Target::Arch::Unknwon) {
+        std::cerr << "scbe-llc: unknown target " << triple << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<Unit> unit;
+    std::unique_ptr<IR::BitcodeReader> bitcode;
+    auto parseBegin = std::chrono::steady_clock::now();
+    try {
+        std::ifstream file(input, std::ios::binary);
+        if(!file) {
+            std::cerr << "scbe-llc: could not open " << input << "\n";
+            return 1;
+        }
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+
+        uint32_t magic = 0;
+        if(source.size() >= 4) std::memcpy(&magic, source.data(), 4);
+        if(magic == IR::Bitcode::s_magic) {
+            bitcode = std::make_unique<IR::BitcodeReader>(input);
+            unit = std::make_unique<Unit>(bitcode->getUnitName(), context);
+            bitcode->readInto(*unit);
+            bitcode->materializeAll();
+        }
+        else unit = IR::Parser(std::move(source), context, input).parse();
+    }
+    catch(std::exception& e) {
+        std::cerr << "scbe-llc: " << e.what() << "\n";
+        return 1;
+    }
+    double parseTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - parseBegin).count();
+
+    if(fileType == Target::FileType::ObjectFile && spec.getArch() != Target::Arch::x86_64) {
+        std::cerr << "scbe-llc: object emission is not supported for " << triple << "\n";
+        return 1;
+    }
+
+    auto machine = context->getTargetRegistry().getTarget(spec)->getTargetMachine(spec, context);
+    unit->setDataLayout(machine->getDataLayout());
+    machine->setObjectFileOptions(objectOptions);
+
+    std::ofstream out(output, std::ios::binary);
+    if(!out) {
+        std::cerr << "scbe-llc: could not open " << output << "\n";
+        return 1;
+    }
+
+    auto passManager = std::make_shared<PassManager>();
+    passManager->setTimePasses(timePasses);
+    if(printAfterAll || printPasses || !printAfter.empty()) {
+        passManager->setAfterPassCallback([&](Pass* pass, Unit& unit) {
+            if(printPasses) std::cerr << pass->getName() << "\n";
+            if(!printAfterAll && std::find(printAfter.begin(), printAfter.end(), pass->getName()) == printAfter.end()) return;
+
+            std::cerr << "*** Dump After " << pass->getName() << " ***\n";
+            bool selected = std::any_of(unit.getFunctions().begin(), unit.getFunctions().end(), [](auto& function) { return function->getMachineFunction() != nullptr; });
+            if(selected) MIR::HumanPrinter(std::cerr, machine->getInstructionInfo(), machine->getRegisterInfo()).print(unit);
+            else IR::HumanPrinter(std::cerr).print(unit);
+        });
+    }
+
+    machine->addPassesForCodeGeneration(passManager, out, fileType, level);
+    try {
+        passManager->run(*unit);
+    }
+    catch(std::exception& e) {
+        std::cerr << "scbe-llc: " << e.what() << "\n";
+        return 1;
+    }
+    out.close();
+
+    if(timePasses) {
+        double total = parseTime;
+        for(auto& [name, time] : passManager->getPassTimings()) total += time;
+        std::fprintf(stderr, "===== Pass execution timing =====\n");
+        std::fprintf(stderr, "  %10.4fs %6.2f%%  %s\n", parseTime, total > 0 ? parseTime * 100 / total : 0, "parse");
+        for(auto& [name, time] : passManager->getPassTimings())
+            std::fprintf(stderr, "  %10.4fs %6.2f%%  %s\n", time, total > 0 ? time * 100 / total : 0, name.c_str());
+        std::fprintf(stderr, "  %10.4fs %6.2f%%  %s\n", total, 100.0, "total");
+    }
+    return 0;
+}